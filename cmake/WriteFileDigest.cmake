@@ -0,0 +1,7 @@
+# Writes "<sha256> <size>" of FILE to FILE.sha256.
+#
+# Run after linking libtriton, so that triton_key() does not have to hash the
+# library when a process compiles its first kernel.
+file(SHA256 "${FILE}" digest)
+file(SIZE "${FILE}" size)
+file(WRITE "${FILE}.sha256" "${digest} ${size}\n")
@@ -2,9 +2,10 @@
 #define TRITON_ANALYSIS_MEMBAR_H
 
 #include "Allocation.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 
-#include <set>
+#include <map>
 
 namespace mlir {
 
@@ -16,7 +17,62 @@ class OpBuilder;
 using MembarFilterFn = std::function<bool(Operation *, Operation *)>;
 
 struct BlockInfo {
-  using IntervalMapT = std::map<Interval<size_t>, std::set<Operation *>>;
+  /// Shared memory intervals with the operations that access each of them.
+  /// The intervals are sorted by start, and the size of the longest one is
+  /// kept, so the intervals that intersect a given interval [start, end) all
+  /// start in [start - maxSize, end) and are found without a full scan.
+  class IntervalMapT {
+  public:
+    using OpSetT = llvm::SmallPtrSet<Operation *, 2>;
+    using MapT = std::map<Interval<size_t>, OpSetT>;
+
+    void insert(Interval<size_t> interval, Operation *op) {
+      intervals[interval].insert(op);
+      maxSize = std::max(maxSize, interval.size());
+    }
+
+    /// Unions two interval maps. The intervals of `other` are visited in
+    /// order, so each one is inserted right before the previous position.
+    void join(const IntervalMapT &other) {
+      auto hint = intervals.begin();
+      for (auto &[interval, ops] : other.intervals) {
+        hint = intervals.try_emplace(hint, interval);
+        hint->second.insert(ops.begin(), ops.end());
+        ++hint;
+      }
+      maxSize = std::max(maxSize, other.maxSize);
+    }
+
+    /// Returns true if `fn` returns true for the operations of any interval
+    /// that intersects `interval`.
+    bool anyIntersecting(Interval<size_t> interval,
+                         llvm::function_ref<bool(const OpSetT &)> fn) const {
+      size_t minStart = interval.start() - std::min(interval.start(), maxSize);
+      for (auto it = intervals.lower_bound(Interval(minStart, minStart));
+           it != intervals.end() && it->first.start() < interval.end(); ++it)
+        if (it->first.intersects(interval) && fn(it->second))
+          return true;
+      return false;
+    }
+
+    void clear() {
+      intervals.clear();
+      maxSize = 0;
+    }
+
+    bool empty() const { return intervals.empty(); }
+    size_t size() const { return intervals.size(); }
+    MapT::const_iterator begin() const { return intervals.begin(); }
+    MapT::const_iterator end() const { return intervals.end(); }
+
+    bool operator==(const IntervalMapT &other) const {
+      return intervals == other.intervals;
+    }
+
+  private:
+    MapT intervals;
+    size_t maxSize = 0;
+  };
 
   IntervalMapT syncReadIntervals;
   IntervalMapT syncWriteIntervals;
@@ -25,12 +81,8 @@ struct BlockInfo {
 
   /// Unions two BlockInfo objects.
   BlockInfo &join(const BlockInfo &other) {
-    for (auto &interval : other.syncReadIntervals)
-      syncReadIntervals[interval.first].insert(interval.second.begin(),
-                                               interval.second.end());
-    for (auto &interval : other.syncWriteIntervals)
-      syncWriteIntervals[interval.first].insert(interval.second.begin(),
-                                                interval.second.end());
+    syncReadIntervals.join(other.syncReadIntervals);
+    syncWriteIntervals.join(other.syncWriteIntervals);
     return *this;
   }
 
@@ -40,14 +92,14 @@ struct BlockInfo {
     err << "  Read Intervals:\n";
     for (auto &[interval, ops] : syncReadIntervals) {
       err << "    [" << interval.start() << ", " << interval.end() << "] ";
-      for (auto &op : ops)
+      for (auto op : ops)
         err << op->getName() << " ";
       err << "\n";
     }
     err << "  Write Intervals:\n";
     for (auto &[interval, ops] : syncWriteIntervals) {
       err << "    [" << interval.start() << ", " << interval.end() << "] ";
-      for (auto &op : ops)
+      for (auto op : ops)
         err << op->getName() << " ";
       err << "\n";
     }
@@ -81,15 +133,29 @@ private:
   bool isIntersected(const IntervalMapT &lhsIntervalSet,
                      const IntervalMapT &rhsIntervalSet,
                      MembarFilterFn filter) const {
-    for (auto &lhs : lhsIntervalSet)
-      for (auto &rhs : rhsIntervalSet)
-        if (lhs.first.intersects(rhs.first))
-          for (auto lhsOp : lhs.second)
-            for (auto rhsOp : rhs.second)
-              if (!filter || !filter(lhsOp, rhsOp))
-                return true;
-
-    return false;
+    using OpSetT = IntervalMapT::OpSetT;
+    auto isOpsIntersected = [&](const OpSetT &lhsOps, const OpSetT &rhsOps) {
+      for (auto lhsOp : lhsOps)
+        for (auto rhsOp : rhsOps)
+          if (!filter || !filter(lhsOp, rhsOp))
+            return true;
+      return false;
+    };
+    // Look up the intervals of the smaller set in the larger one, which is
+    // usually the block's set against the current operation's.
+    if (lhsIntervalSet.size() <= rhsIntervalSet.size())
+      return llvm::any_of(lhsIntervalSet, [&](const auto &lhs) {
+        return rhsIntervalSet.anyIntersecting(
+            lhs.first, [&](const OpSetT &rhsOps) {
+              return isOpsIntersected(lhs.second, rhsOps);
+            });
+      });
+    return llvm::any_of(rhsIntervalSet, [&](const auto &rhs) {
+      return lhsIntervalSet.anyIntersecting(
+          rhs.first, [&](const OpSetT &lhsOps) {
+            return isOpsIntersected(lhsOps, rhs.second);
+          });
+    });
   }
 };
 
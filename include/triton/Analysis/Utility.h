@@ -53,6 +53,13 @@ public:
 
   bool isWarpSynchronous();
 
+  // Whether every thread should combine the partial results of all the warps
+  // straight from shared memory, instead of going through a second round of
+  // shuffles. This takes a single barrier instead of two, at the cost of
+  // loading each partial result in every thread that needs it, and is only
+  // worth it when the reduction axis spans many warps.
+  bool isSingleBarrierReduction();
+
   unsigned getInterWarpSize();
 
   unsigned getIntraWarpSize();
@@ -139,9 +146,13 @@ public:
   Location getLoc() { return scanOp.getLoc(); }
   unsigned getAxis() { return scanOp.getAxis(); }
   bool getReverse() { return scanOp.getReverse(); }
+  // Return true if the last operand holds segment head flags.
+  bool isSegmented() { return scanOp.getSegmented(); }
+  bool isExclusive() { return scanOp.getExclusive(); }
   triton::gpu::BlockedEncodingAttr getEncoding();
   llvm::ArrayRef<int64_t> getShape() { return srcShape; }
   unsigned getNumOperands() { return scanOp.getNumOperands(); }
+  unsigned getNumCombinedOperands() { return scanOp.getNumCombinedOperands(); }
   SmallVector<Type> getElementTypes() { return srcElementTypes; }
   Attribute getSrcLayout() { return srcEncoding; }
   Region &getCombineOp();
@@ -168,6 +179,29 @@ private:
   triton::GatherOp gatherOp;
 };
 
+// Lowers tt.sort and tt.topk as a bitonic sort along the axis. Each stage
+// compares elements whose positions along the axis differ by one bit, and that
+// bit is held either by the registers of a thread, by the lanes of a warp or
+// by the warps of the CTA.
+class SortLoweringHelper {
+public:
+  explicit SortLoweringHelper(triton::SortOp op);
+  explicit SortLoweringHelper(triton::TopKOp op);
+
+  // Whether the layout of the source lets every bit of the axis be flipped by
+  // a single register, lane or warp bit, within a CTA.
+  bool isSupported();
+  // Whether all the elements of each row along the axis are in the same warp.
+  bool isWarpLocal();
+  // Get the shared memory scratch size required by this op.
+  unsigned getScratchSizeInBytes();
+
+private:
+  Operation *op;
+  RankedTensorType srcTy;
+  int axis;
+};
+
 // This struct represents a decomposed layout conversion within a warp into
 // three transformations: P1 and P2 represent lane-dependent register shuffles
 // and W represents a warp shuffle. P2^-1 is returned because it represents the
@@ -418,6 +452,15 @@ std::unique_ptr<DataFlowSolver> createDataFlowSolver();
 
 triton::MakeTensorPtrOp getMakeTensorPtrOp(Value v);
 
+/// Estimates the number of 32-bit registers per thread that hold the
+/// distributed tensors of `funcOp` live at the same time.  Splats, constants
+/// and ranges are not counted, as the lowering folds them into their users.
+/// This is only an estimate of the registers of the lowered kernel, which can
+/// be higher or lower: it ignores scalars and the temporaries of the lowering,
+/// it counts tensors that LLVM may fold or rematerialize, and a value live
+/// across a region that does not use it is only counted outside of the region.
+unsigned estimateRegisterPressure(FunctionOpInterface funcOp);
+
 } // namespace mlir
 
 #endif // TRITON_ANALYSIS_UTILITY_H
@@ -44,7 +44,9 @@ public:
   std::optional<LinearLayout> get(const CacheKey &key) {
     std::shared_lock lock(mutex);
     auto it = cache.find(key);
-    if (it != cache.end()) {
+    bool hit = it != cache.end();
+    recordLayoutCacheLookup(LayoutCacheKind::ToLinearLayout, hit);
+    if (hit) {
       return it->second;
     }
     return std::nullopt;
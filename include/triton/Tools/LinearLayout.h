@@ -167,6 +167,15 @@ namespace mlir::triton {
 // that map to the same output value.  This represents the idea that the same
 // logical tensor elements can be stored in multiple places in the hardware.
 //
+// ## Bit-packed bases
+//
+// Next to the readable `bases`, an LL keeps each basis as a single uint64_t
+// GF(2) column: the basis's out-dim values are concatenated, minor-to-major, in
+// the order of the out-dims.  Basis j of the flattened input is column j.
+// apply, compose, the surjectivity check and getFreeVariableMasks work on these
+// columns with xor and bit-scan loops rather than on the nested vectors.  This
+// is why an LL's total in and out sizes are limited to 2^64.
+//
 // ## Why map hardware loc -> tensor index and not the other way around?
 //
 // In Triton, a linear layout usually tells us which logical tensor value is
@@ -326,6 +335,10 @@ private:
   llvm::MapVector<StringAttr, int32_t /*size*/> outDims;
   bool surjective;
 
+  // basisMasks[j] is the j'th basis of the flattened input, packed as
+  // described in "Bit-packed bases" above.  Derived from `bases` and `outDims`.
+  SmallVector<uint64_t> basisMasks;
+
 public:
   using BasesT = decltype(bases);
 
@@ -436,6 +449,10 @@ public:
     return getBasis(inDim, pos)[getOutDimIndex(outDim)];
   }
 
+  // The bases of the flattened input as bit-packed GF(2) columns; see
+  // "Bit-packed bases" above.
+  ArrayRef<uint64_t> getBasisMasks() const { return basisMasks; }
+
   // These are in minor-to-major order, although if you don't flatten the dims
   // (e.g. by reshaping) then the order doesn't really affect anything.
   auto getInDimNames() const { return llvm::make_first_range(bases); }
@@ -718,6 +735,24 @@ public:
   friend size_t hash_value(const LinearLayout &layout);
 
 private:
+  friend class LayoutOpCache;
+
+  // Uncached implementations of the operations above that are memoized by
+  // LayoutOpCache.
+  LinearLayout composeImpl(const LinearLayout &outer) const;
+  LinearLayout invertAndComposeImpl(const LinearLayout &outer) const;
+  std::optional<LinearLayout> quotientImpl(ArrayRef<StringAttr> dimNames) const;
+
+  // Fills basisMasks from bases and outDims.  Called by the constructors.
+  void computeBasisMasks();
+
+  // Applies the layout to a flattened input, returning the flattened output.
+  // Both are packed as described in "Bit-packed bases" above.
+  uint64_t applyPacked(uint64_t ins) const;
+
+  // Splits a packed output into its value along each out-dim.
+  std::vector<int32_t> unpackOuts(uint64_t outs) const;
+
   // Factory function that gracefully fails rather than asserts if the layout is
   // not well-formed.
   static std::optional<LinearLayout>
@@ -744,6 +779,22 @@ inline std::ostream &operator<<(std::ostream &os, const LinearLayout &layout) {
   return os;
 }
 
+// The layout computations that are memoized, either by the TritonGPU dialect
+// (toLinearLayout) or by each thread (the LinearLayout operations).
+enum class LayoutCacheKind {
+  ToLinearLayout,
+  Compose,
+  InvertAndCompose,
+  Quotient,
+};
+
+// Counts a lookup in the cache of the given kind.
+void recordLayoutCacheLookup(LayoutCacheKind kind, bool hit);
+
+// Prints the number of hits and misses of each layout cache since the start of
+// the process.
+void printLayoutCacheStatistics(llvm::raw_ostream &os);
+
 } // namespace mlir::triton
 
 #endif // TRITON_TOOLS_LINEARLAYOUT_H
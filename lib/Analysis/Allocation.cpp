@@ -2,7 +2,10 @@
 
 #include <algorithm>
 #include <limits>
+#include <map>
 #include <numeric>
+#include <optional>
+#include <random>
 
 #include "mlir/Analysis/Liveness.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
@@ -11,6 +14,7 @@
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -153,6 +157,14 @@ unsigned defaultAllocationAnalysisScratchSizeFn(Operation *op) {
     GatherLoweringHelper helper(gatherOp);
     return helper.getScratchSizeInBytes();
   }
+  if (auto sortOp = dyn_cast<SortOp>(op)) {
+    SortLoweringHelper helper(sortOp);
+    return helper.getScratchSizeInBytes();
+  }
+  if (auto topkOp = dyn_cast<TopKOp>(op)) {
+    SortLoweringHelper helper(topkOp);
+    return helper.getScratchSizeInBytes();
+  }
   if (auto histogram = dyn_cast<HistogramOp>(op)) {
     auto dstTy = histogram.getType();
     int threadsPerWarp = gpu::TritonGPUDialect::getThreadsPerWarp(
@@ -200,6 +212,16 @@ unsigned defaultAllocationAnalysisScratchSizeFn(Operation *op) {
   return 0;
 }
 
+/// Returns the number of steps of the search for a smaller shared memory
+/// allocation than the greedy one, if TRITON_SMEM_SEARCH_STEPS is set.
+static std::optional<unsigned> getSearchSteps() {
+  std::string steps = tools::getStrEnv("TRITON_SMEM_SEARCH_STEPS");
+  unsigned numSteps = 0;
+  if (StringRef(steps).getAsInteger(10, numSteps) || numSteps == 0)
+    return std::nullopt;
+  return numSteps;
+}
+
 class AllocationAnalysis {
 public:
   AllocationAnalysis(Operation *operation,
@@ -429,7 +451,7 @@ private:
     }
   }
 
-  void dumpAllocationSize() {
+  void dumpAllocationSize(size_t greedySize) {
     LDBG("Dump shared memory allocation size -----------");
     auto liveBuffers = allocation->getLiveBuffers();
     auto analyzedSize = 0;
@@ -442,6 +464,7 @@ private:
       analyzedSize = std::max(analyzedSize, size);
     }
     llvm::dbgs() << "Allocated: " << allocation->sharedMemorySize
+                 << ", greedy: " << greedySize
                  << ", analyzed: " << analyzedSize << "\n";
   }
 
@@ -490,7 +513,11 @@ private:
       buildInterferenceGraph(buffers, interference);
     } while (!interference.empty());
 
-    LLVM_DEBUG(dumpAllocationSize());
+    size_t greedySize = allocation->sharedMemorySize;
+    if (auto numSteps = getSearchSteps())
+      searchOffsets(buffers, *numSteps);
+
+    LLVM_DEBUG(dumpAllocationSize(greedySize));
   }
 
   /// Computes the initial shared memory offsets.
@@ -524,11 +551,11 @@ private:
       auto bufferIt =
           std::find_if(xBuffers.begin(), xBuffers.end(), [&](auto *buffer) {
             auto xRange = bufferRange[buffer];
-            bool res = xRange.intersects(range);
-            for (const auto &val : tripleMap)
-              res = res &&
-                    !val.second.intersects(xRange); // only one buffer intersect
-            return res;
+            // only one buffer intersect
+            return xRange.intersects(range) &&
+                   llvm::none_of(tripleMap, [&](const auto &val) {
+                     return val.second.intersects(xRange);
+                   });
           });
       if (bufferIt != xBuffers.end()) {
         auto buffer = *bufferIt;
@@ -560,23 +587,43 @@ private:
                               GraphT &interference) {
     // Reset interference graph
     interference.clear();
-    for (auto x : buffers) {
-      for (auto y : buffers) {
-        if (x == y)
-          continue;
-        auto xStart = x->offset;
-        auto yStart = y->offset;
-        auto xSize = x->size;
-        auto ySize = y->size;
-        Interval xSizeRange = {xStart, xStart + xSize};
-        Interval ySizeRange = {yStart, yStart + ySize};
-        auto xOpRange = bufferRange.lookup(x);
-        auto yOpRange = bufferRange.lookup(y);
+    // Sweep the buffers in the order of the start of their liveness ranges.
+    // Only the buffers that are still live when a buffer starts can overlap
+    // with it, and they are kept ordered by offset so that the scan for
+    // address overlaps stops at the first buffer placed after it.
+    SmallVector<std::pair<BufferT *, Interval<size_t>>> sweepBuffers;
+    for (auto x : buffers)
+      sweepBuffers.emplace_back(x, bufferRange.lookup(x));
+    llvm::stable_sort(sweepBuffers, [](const auto &lhs, const auto &rhs) {
+      return lhs.second.start() < rhs.second.start();
+    });
+    using LiveBufferMapT =
+        std::multimap<size_t, std::pair<BufferT *, Interval<size_t>>>;
+    // Offset -> (buffer, liveness range)
+    LiveBufferMapT liveBuffers;
+    // Liveness end -> entry in liveBuffers
+    std::multimap<size_t, LiveBufferMapT::iterator> liveBufferEnds;
+    for (auto [x, xOpRange] : sweepBuffers) {
+      // Buffers that are dead before x starts can't overlap with x or any
+      // buffer after it.
+      while (!liveBufferEnds.empty() &&
+             liveBufferEnds.begin()->first <= xOpRange.start()) {
+        liveBuffers.erase(liveBufferEnds.begin()->second);
+        liveBufferEnds.erase(liveBufferEnds.begin());
+      }
+      Interval xSizeRange = {x->offset, x->offset + x->size};
+      auto liveEnd = liveBuffers.lower_bound(xSizeRange.end());
+      for (auto it = liveBuffers.begin(); it != liveEnd; ++it) {
+        auto [y, yOpRange] = it->second;
+        Interval ySizeRange = {y->offset, y->offset + y->size};
         if (xOpRange.intersects(yOpRange) &&
             xSizeRange.intersects(ySizeRange)) {
           interference[x].insert(y);
+          interference[y].insert(x);
         }
       }
+      auto liveIt = liveBuffers.insert({x->offset, {x, xOpRange}});
+      liveBufferEnds.insert({xOpRange.end(), liveIt});
     }
 
     LLVM_DEBUG(dumpInterferenceGraph(interference));
@@ -596,12 +643,15 @@ private:
     for (auto value : buffers) {
       colors[value] = (value == buffers[0]) ? 0 : -1;
     }
-    SmallVector<bool> available(buffers.size());
+    SmallVector<bool> available;
     for (auto x : buffers) {
-      std::fill(available.begin(), available.end(), true);
-      for (auto y : interference.lookup(x)) {
+      // A node with n neighbors always has one of the first n + 1 colors
+      // available.
+      const auto &neighbors = interference.lookup(x);
+      available.assign(neighbors.size() + 1, true);
+      for (auto y : neighbors) {
         int color = colors[y];
-        if (color >= 0) {
+        if (color >= 0 && static_cast<size_t>(color) < available.size()) {
           available[color] = false;
         }
       }
@@ -630,6 +680,156 @@ private:
     LLVM_DEBUG(dumpBuffers());
   }
 
+  /// Searches for offsets that need less shared memory than the current
+  /// allocation, and applies them if any are found within `numSteps` steps.
+  /// The search is deterministic, so the result only depends on the buffers
+  /// and the number of steps.
+  ///
+  /// A candidate allocation places the buffers one at a time, in a given
+  /// order, at the lowest aligned offset that doesn't overlap any placed buffer
+  /// whose liveness range intersects its own. Best-fit decreasing orders by
+  /// size, lifetime, and size times lifetime are tried first. The best of them
+  /// is then improved by a local search over the order, which tries one
+  /// order per step, until the steps are spent or the allocation is as small
+  /// as the peak number of live bytes.
+  void searchOffsets(const SmallVector<BufferT *> &buffers,
+                     unsigned numSteps) {
+    unsigned numBuffers = buffers.size();
+    SmallVector<Interval<size_t>> ranges;
+    for (auto x : buffers)
+      ranges.push_back(bufferRange.lookup(x));
+
+    // Neighbors are buffers whose liveness ranges intersect.
+    SmallVector<unsigned> byStart(numBuffers);
+    std::iota(byStart.begin(), byStart.end(), 0);
+    llvm::stable_sort(byStart, [&](unsigned lhs, unsigned rhs) {
+      return ranges[lhs].start() < ranges[rhs].start();
+    });
+    SmallVector<SmallVector<unsigned>> neighbors(numBuffers);
+    for (auto it = byStart.begin(); it != byStart.end(); ++it) {
+      for (auto jt = std::next(it); jt != byStart.end() &&
+                                    ranges[*jt].start() < ranges[*it].end();
+           ++jt) {
+        if (ranges[*it].intersects(ranges[*jt])) {
+          neighbors[*it].push_back(*jt);
+          neighbors[*jt].push_back(*it);
+        }
+      }
+    }
+
+    // No allocation is smaller than the peak number of live bytes.
+    SmallVector<std::pair<size_t, int64_t>> events;
+    for (auto [x, range] : llvm::zip(buffers, ranges)) {
+      events.emplace_back(range.start(), x->size);
+      events.emplace_back(range.end(), -static_cast<int64_t>(x->size));
+    }
+    llvm::sort(events);
+    size_t lowerBound = 0;
+    int64_t liveSize = 0;
+    for (auto [time, delta] : events) {
+      liveSize += delta;
+      lowerBound = std::max(lowerBound, static_cast<size_t>(liveSize));
+    }
+
+    constexpr size_t kUnplaced = std::numeric_limits<size_t>::max();
+    SmallVector<size_t> offsets(numBuffers, kUnplaced);
+    SmallVector<std::pair<size_t, size_t>> occupied;
+    auto place = [&](unsigned x) {
+      occupied.clear();
+      for (auto y : neighbors[x])
+        if (offsets[y] != kUnplaced)
+          occupied.emplace_back(offsets[y], offsets[y] + buffers[y]->size);
+      llvm::sort(occupied);
+      size_t offset = 0;
+      for (auto [start, end] : occupied) {
+        if (start >= offset + buffers[x]->size)
+          break;
+        if (end > offset)
+          offset = llvm::alignTo(end, buffers[x]->alignment);
+      }
+      return offset;
+    };
+
+    // The best allocation so far, which is only applied if it is smaller than
+    // the current one, and the order that the search continues from.
+    size_t bestSize = allocation->sharedMemorySize;
+    SmallVector<size_t> bestOffsets;
+    size_t currentSize = std::numeric_limits<size_t>::max();
+    SmallVector<size_t> currentOffsets;
+    SmallVector<unsigned> currentOrder;
+    auto tryOrder = [&](ArrayRef<unsigned> order) {
+      size_t size = 0;
+      for (auto x : order) {
+        offsets[x] = place(x);
+        size = std::max(size, offsets[x] + buffers[x]->size);
+        if (size > currentSize)
+          break;
+      }
+      if (size <= currentSize) {
+        currentSize = size;
+        currentOffsets = offsets;
+        currentOrder.assign(order.begin(), order.end());
+        if (size < bestSize) {
+          bestSize = size;
+          bestOffsets = offsets;
+        }
+      }
+      offsets.assign(numBuffers, kUnplaced);
+    };
+
+    auto lifetime = [&](unsigned x) { return ranges[x].size(); };
+    SmallVector<unsigned> order(numBuffers);
+    std::iota(order.begin(), order.end(), 0);
+    llvm::stable_sort(order, [&](unsigned lhs, unsigned rhs) {
+      return buffers[lhs]->size > buffers[rhs]->size;
+    });
+    tryOrder(order);
+    llvm::stable_sort(order, [&](unsigned lhs, unsigned rhs) {
+      return lifetime(lhs) > lifetime(rhs);
+    });
+    tryOrder(order);
+    llvm::stable_sort(order, [&](unsigned lhs, unsigned rhs) {
+      return buffers[lhs]->size * lifetime(lhs) >
+             buffers[rhs]->size * lifetime(rhs);
+    });
+    tryOrder(order);
+
+    // Improve on the best order by moving a buffer to an earlier position,
+    // and keep the move unless the allocation grows. Buffers that end at the
+    // top of the allocation are moved most of the time, since the allocation
+    // can only shrink if they are placed lower. Moves that don't grow the
+    // allocation are kept so that the search can cross plateaus.
+    for (auto x : buffers)
+      lowerBound = std::max(lowerBound, x->size);
+    std::mt19937 rng;
+    SmallVector<unsigned> top;
+    for (unsigned step = 0; step < numSteps && bestSize > lowerBound;
+         ++step) {
+      top.clear();
+      for (auto [i, x] : llvm::enumerate(currentOrder))
+        if (currentOffsets[x] + buffers[x]->size == currentSize)
+          top.push_back(i);
+      unsigned from =
+          rng() % 4 == 0 ? rng() % numBuffers : top[rng() % top.size()];
+      if (from == 0)
+        continue;
+      order = currentOrder;
+      unsigned to = rng() % from;
+      std::rotate(order.begin() + to, order.begin() + from,
+                  order.begin() + from + 1);
+      tryOrder(order);
+    }
+
+    LDBG("Searched allocation size: " << bestSize << ", lower bound: "
+                                      << lowerBound);
+    if (bestOffsets.empty())
+      return;
+    for (auto [x, offset] : llvm::zip(buffers, bestOffsets))
+      x->offset = offset;
+    allocation->sharedMemorySize = bestSize;
+    LLVM_DEBUG(dumpBuffers());
+  }
+
 private:
   Operation *operation;
   Allocation::FuncAllocMapT *funcAllocMap;
@@ -4,6 +4,7 @@
 
 #include "mlir/Analysis/DataFlow/ConstantPropagationAnalysis.h"
 #include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/Liveness.h"
 #include "mlir/Conversion/LLVMCommon/Pattern.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
@@ -168,6 +169,24 @@ bool ReduceOpHelper::isWarpSynchronous() {
   return getWarpsPerCTAWithUniqueData(srcLayout, srcShape)[axis] == 1;
 }
 
+bool ReduceOpHelper::isSingleBarrierReduction() {
+  // Below this many warps along the axis, the second round of shuffles is
+  // cheaper than the extra shared memory loads.
+  constexpr unsigned kMinInterWarps = 8;
+  // Bounds the number of shared memory loads emitted per thread.
+  constexpr unsigned kMaxLoadsPerThread = 64;
+  if (isWarpSynchronous())
+    return false;
+  unsigned sizeInterWarps = getInterWarpSizeWithUniqueData();
+  if (sizeInterWarps < kMinInterWarps)
+    return false;
+  unsigned resultElems = 1;
+  if (auto resultTy = dyn_cast<RankedTensorType>(op.getResult()[0].getType()))
+    resultElems = triton::gpu::getTotalElemsPerThread(resultTy);
+  return resultElems * sizeInterWarps * op.getNumOperands() <=
+         kMaxLoadsPerThread;
+}
+
 SmallVector<unsigned> ReduceOpHelper::getScratchRepShape() {
   SmallVector<unsigned> smemShape;
   // that case doesn't need inter-warp communication
@@ -621,6 +640,62 @@ unsigned ScanLoweringHelper::getAxisBlockStride() {
   llvm_unreachable("Axis not found in order");
 }
 
+SortLoweringHelper::SortLoweringHelper(triton::SortOp op)
+    : op(op), srcTy(op.getSrc().getType()), axis(op.getAxis()) {}
+
+SortLoweringHelper::SortLoweringHelper(triton::TopKOp op)
+    : op(op), srcTy(op.getSrc().getType()), axis(op.getAxis()) {}
+
+bool SortLoweringHelper::isSupported() {
+  LinearLayout layout = toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  Builder b(op->getContext());
+  StringAttr kAxis = b.getStringAttr("dim" + Twine(axis));
+  StringAttr kBlock = b.getStringAttr("block");
+  if (!layout.sublayoutIsZero(kBlock, kAxis))
+    return false;
+  // Every bit of the axis must be the image of a basis that changes nothing
+  // else, so that the partner of an element is held by the same register of
+  // another lane or warp, or by another register of the same thread.
+  unsigned axisIdx = layout.getOutDimIndex(kAxis);
+  int32_t found = 0;
+  for (StringAttr inDim : layout.getInDimNames()) {
+    for (int i = 0; i < layout.getInDimSizeLog2(inDim); ++i) {
+      ArrayRef<int32_t> basis = layout.getBasis(inDim, i);
+      for (auto [outIdx, value] : llvm::enumerate(basis)) {
+        if (outIdx != axisIdx || value == 0)
+          continue;
+        if (!llvm::isPowerOf2_32(value) || (found & value) ||
+            llvm::count_if(basis, [](int32_t v) { return v != 0; }) != 1)
+          return false;
+        found |= value;
+      }
+    }
+  }
+  return found == srcTy.getShape()[axis] - 1;
+}
+
+bool SortLoweringHelper::isWarpLocal() {
+  LinearLayout layout = toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  Builder b(op->getContext());
+  StringAttr kAxis = b.getStringAttr("dim" + Twine(axis));
+  return layout.sublayoutIsZero(
+      {b.getStringAttr("block"), b.getStringAttr("warp")}, kAxis);
+}
+
+unsigned SortLoweringHelper::getScratchSizeInBytes() {
+  // The stages across warps and the extraction of the top-k go through shared
+  // memory, with the whole source tensor of the CTA. The i32 positions of a
+  // top-k with indices take the same round trips, one after the values.
+  if (isa<triton::SortOp>(op) && isWarpLocal())
+    return 0;
+  unsigned bitWidth = srcTy.getElementTypeBitWidth();
+  auto topkOp = dyn_cast<triton::TopKOp>(op);
+  if (topkOp && topkOp.getIndices())
+    bitWidth = std::max(bitWidth, 32u);
+  return product(triton::gpu::getShapePerCTA(srcTy)) *
+         ceil<unsigned>(bitWidth, 8);
+}
+
 GatherLoweringHelper::GatherLoweringHelper(triton::GatherOp gatherOp)
     : gatherOp(gatherOp) {}
 
@@ -1251,4 +1326,54 @@ MakeTensorPtrOp getMakeTensorPtrOp(Value v) {
   llvm_unreachable("Unable to getMakeTensorPtr()");
 }
 
+unsigned estimateRegisterPressure(FunctionOpInterface funcOp) {
+  auto getNumRegisters = [](Value value) -> unsigned {
+    // Splats, constants and ranges are the same for every thread or are
+    // computed from the thread id, and the lowering folds them into their
+    // users.
+    if (isa_and_nonnull<triton::SplatOp, arith::ConstantOp,
+                        triton::MakeRangeOp>(value.getDefiningOp()))
+      return 0;
+    auto tensorTy = dyn_cast<RankedTensorType>(value.getType());
+    if (!tensorTy || !isa_and_nonnull<triton::gpu::DistributedEncodingTrait>(
+                         tensorTy.getEncoding()))
+      return 0;
+    Type elemTy = tensorTy.getElementType();
+    unsigned bitWidth = isa<triton::PointerType>(elemTy)
+                            ? 64
+                            : elemTy.getIntOrFloatBitWidth();
+    return ceil<unsigned>(
+        triton::gpu::getTotalElemsPerThread(tensorTy) * bitWidth, 32);
+  };
+
+  // Sweep each block once: a value occupies its registers from its definition
+  // (or the start of the block) to the end of its live range in the block.
+  Liveness liveness(funcOp);
+  unsigned maxRegisters = 0;
+  funcOp->walk([&](Block *block) {
+    const LivenessBlockInfo *info = liveness.getLiveness(block);
+    if (!info || block->empty())
+      return;
+    DenseMap<Operation *, unsigned> freed;
+    unsigned registers = 0;
+    auto addValue = [&](Value value, Operation *start) {
+      if (unsigned numRegisters = getNumRegisters(value)) {
+        registers += numRegisters;
+        freed[info->getEndOperation(value, start)] += numRegisters;
+      }
+    };
+    for (Value value : info->in())
+      addValue(value, &block->front());
+    for (BlockArgument arg : block->getArguments())
+      addValue(arg, &block->front());
+    for (Operation &op : *block) {
+      for (Value result : op.getResults())
+        addValue(result, &op);
+      maxRegisters = std::max(maxRegisters, registers);
+      registers -= freed.lookup(&op);
+    }
+  });
+  return maxRegisters;
+}
+
 } // namespace mlir
@@ -34,8 +34,10 @@ public:
     auto srcValues = unpackInputs(loc, op, adaptor, rewriter);
     std::map<SmallVector<unsigned>, SmallVector<Value>> accs;
     std::map<SmallVector<unsigned>, SmallVector<Value>> indices;
+    bool singleBarrier = helper.isSingleBarrierReduction();
     // First reduce all the values along axis within each thread.
-    reduceWithinThreads(helper, srcValues, accs, indices, rewriter);
+    reduceWithinThreads(helper, srcValues, accs, indices, rewriter,
+                        /*treeReduce=*/singleBarrier);
 
     // Then reduce across threads within a warp.
     reduceWithinWarps(helper, accs, rewriter);
@@ -57,6 +59,15 @@ public:
 
     sync(rewriter, loc, op);
 
+    if (singleBarrier) {
+      // Every thread combines the partial results of all the warps for its
+      // own result elements, which needs neither a second round of shuffles
+      // nor a second barrier.
+      loadAndAccumulatePartialReductions(helper, smemShape, smemBases,
+                                         rewriter);
+      return success();
+    }
+
     // The second round of shuffle reduction
     //   now the problem size: sizeInterWarps, s1, s2, .. , sn
     //   where sizeInterWarps is 2^m
@@ -91,6 +102,26 @@ private:
     }
   }
 
+  // Combine `values` pairwise, in order, so that the combines of each level are
+  // independent of each other rather than one long chain.
+  SmallVector<Value>
+  treeAccumulate(Location loc, ConversionPatternRewriter &rewriter,
+                 Region &combineOp,
+                 SmallVector<SmallVector<Value>> values) const {
+    assert(!values.empty());
+    while (values.size() > 1) {
+      SmallVector<SmallVector<Value>> next;
+      for (unsigned i = 0; i + 1 < values.size(); i += 2) {
+        next.push_back(values[i]);
+        accumulate(loc, rewriter, combineOp, next.back(), values[i + 1]);
+      }
+      if (values.size() % 2 == 1)
+        next.push_back(values.back());
+      values = std::move(next);
+    }
+    return values.front();
+  }
+
   SmallVector<SmallVector<Value>>
   unpackInputs(Location loc, triton::ReduceOp op, OpAdaptor adaptor,
                ConversionPatternRewriter &rewriter) const {
@@ -116,12 +147,15 @@ private:
   }
 
   // Reduce along op axis for elements that are in the same thread. The
-  // accumulated value is stored in accs.
+  // accumulated value is stored in accs. With `treeReduce`, the values of each
+  // key are combined as a tree, which shortens the dependency chains of
+  // multi-operand combines such as argmax and lets independent combines be
+  // vectorized.
   void reduceWithinThreads(
       ReduceOpHelper &helper, SmallVector<SmallVector<Value>> &srcValues,
       std::map<SmallVector<unsigned>, SmallVector<Value>> &accs,
       std::map<SmallVector<unsigned>, SmallVector<Value>> &indices,
-      ConversionPatternRewriter &rewriter) const {
+      ConversionPatternRewriter &rewriter, bool treeReduce = false) const {
     triton::ReduceOp op = helper.getOperation();
     RankedTensorType operandType = op.getInputTypes()[0];
     // Assumes offsets don't actually depend on type
@@ -140,6 +174,21 @@ private:
     auto *combineOp = &op.getCombineOp();
     auto srcIndices = emitIndices(op.getLoc(), rewriter, targetInfo,
                                   helper.getSrcLayout(), operandType, true);
+    if (treeReduce) {
+      std::map<SmallVector<unsigned>, SmallVector<SmallVector<Value>>> values;
+      for (const auto &[_, i] : uniqueOffsets) {
+        SmallVector<unsigned> key = offsets[i];
+        key[op.getAxis()] = 0;
+        auto &keyValues = values[key];
+        if (keyValues.empty())
+          indices[key] = srcIndices[i];
+        keyValues.push_back(srcValues[i]);
+      }
+      for (auto &[key, keyValues] : values)
+        accs[key] = treeAccumulate(op.getLoc(), rewriter, *combineOp,
+                                   std::move(keyValues));
+      return;
+    }
     // reduce within threads
     for (const auto &[_, i] : uniqueOffsets) {
       SmallVector<unsigned> key = offsets[i];
@@ -331,6 +380,97 @@ private:
     }
   }
 
+  // Return the index in the shared memory scratch of each result element held
+  // by this thread, with 0 along the reduction axis.
+  SmallVector<SmallVector<Value>>
+  getResultSmemIndices(ReduceOpHelper &helper, RankedTensorType resultTy,
+                       ArrayRef<unsigned> smemShape,
+                       ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    auto resultLayout = cast<SliceEncodingAttr>(resultTy.getEncoding());
+    unsigned resultElems = getTotalElemsPerThread(resultTy);
+    auto resultIndices =
+        emitIndices(loc, rewriter, targetInfo, resultLayout, resultTy, true);
+    auto resultShape = resultTy.getShape();
+    auto resultCTATile = getShapePerCTATile(resultLayout);
+    assert(resultIndices.size() == resultElems);
+
+    SmallVector<SmallVector<Value>> readIndices(resultElems);
+    for (size_t j = 0; j < resultElems; ++j) {
+      SmallVector<Value> &readIdx = readIndices[j];
+      readIdx = resultIndices[j];
+      readIdx.insert(readIdx.begin() + op.getAxis(), b.i32_val(0));
+      for (size_t resultIdx = 0, resultDim = resultShape.size();
+           resultIdx < resultDim; ++resultIdx) {
+        auto smemIdx = resultIdx < op.getAxis() ? resultIdx : resultIdx + 1;
+        if (resultCTATile[resultIdx] > smemShape[smemIdx] ||
+            resultShape[resultIdx] > smemShape[smemIdx]) {
+          // When srcShape smaller then src sizePerThread, only srcShape
+          // elements is accumulated in smem. Modulo smemShape effectively
+          // replicates srcShape elements to src sizePerThread.
+          readIdx[smemIdx] =
+              b.urem(readIdx[smemIdx], b.i32_val(smemShape[smemIdx]));
+        }
+      }
+    }
+    return readIndices;
+  }
+
+  // Load the partial reduction of every warp for each result element held by
+  // this thread, combine them and replace the reduce result with it. All the
+  // operands go through the same single round of shared memory.
+  void loadAndAccumulatePartialReductions(
+      ReduceOpHelper &helper, SmallVector<unsigned> smemShape,
+      SmallVector<Value> &smemBases,
+      ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    unsigned axis = op.getAxis();
+    unsigned sizeInterWarps = smemShape[axis];
+    auto smemOrder = helper.getOrderWithAxisAtBeginning();
+    auto resultTy = dyn_cast<RankedTensorType>(op.getResult()[0].getType());
+
+    // A 0d-tensor result reduces a 1d-tensor, whose partial results are
+    // contiguous.
+    SmallVector<SmallVector<Value>> readIndices = {{b.i32_val(0)}};
+    if (resultTy)
+      readIndices = getResultSmemIndices(helper, resultTy, smemShape, rewriter);
+
+    SmallVector<SmallVector<Value>> resultVals(op.getNumOperands());
+    for (SmallVector<Value> &readIdx : readIndices) {
+      SmallVector<SmallVector<Value>> partials(sizeInterWarps);
+      for (unsigned k = 0; k < sizeInterWarps; ++k) {
+        readIdx[axis] = b.i32_val(k);
+        Value readOffset =
+            linearize(rewriter, loc, readIdx, smemShape, smemOrder);
+        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+          auto elemTy = getElementType(op, i);
+          Value readPtr =
+              b.gep(smemBases[i].getType(), elemTy, smemBases[i], readOffset);
+          partials[k].push_back(b.load(elemTy, readPtr));
+        }
+      }
+      auto acc = treeAccumulate(loc, rewriter, op.getCombineOp(),
+                                std::move(partials));
+      for (unsigned i = 0; i < op.getNumOperands(); ++i)
+        resultVals[i].push_back(acc[i]);
+    }
+
+    SmallVector<Value> results(op.getNumOperands());
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      if (auto resultTy =
+              dyn_cast<RankedTensorType>(op.getResult()[i].getType()))
+        results[i] = packLLElements(loc, getTypeConverter(), resultVals[i],
+                                    rewriter, resultTy);
+      else
+        results[i] = resultVals[i][0];
+    }
+    rewriter.replaceOp(op, results);
+  }
+
   // Load the final reduction from shared memory and replace the reduce result
   // with it.
   void loadReductionAndPackResult(ReduceOpHelper &helper,
@@ -349,32 +489,13 @@ private:
       if (auto resultTy =
               dyn_cast<RankedTensorType>(op.getResult()[i].getType())) {
         // nd-tensor where n >= 1
-        auto resultLayout = cast<SliceEncodingAttr>(resultTy.getEncoding());
         unsigned resultElems = getTotalElemsPerThread(resultTy);
-        auto resultIndices = emitIndices(loc, rewriter, targetInfo,
-                                         resultLayout, resultTy, true);
-        auto resultShape = resultTy.getShape();
-        auto resultCTATile = getShapePerCTATile(resultLayout);
-        assert(resultIndices.size() == resultElems);
-
         SmallVector<Value> resultVals(resultElems);
+        auto readIndices =
+            getResultSmemIndices(helper, resultTy, smemShape, rewriter);
         for (size_t j = 0; j < resultElems; ++j) {
-          SmallVector<Value> readIdx = resultIndices[j];
-          readIdx.insert(readIdx.begin() + op.getAxis(), b.i32_val(0));
-          for (size_t resultIdx = 0, resultDim = resultShape.size();
-               resultIdx < resultDim; ++resultIdx) {
-            auto smemIdx = resultIdx < op.getAxis() ? resultIdx : resultIdx + 1;
-            if (resultCTATile[resultIdx] > smemShape[smemIdx] ||
-                resultShape[resultIdx] > smemShape[smemIdx]) {
-              // When srcShape smaller then src sizePerThread, only srcShape
-              // elements is accumulated in smem. Modulo smemShape effectively
-              // replicates srcShape elements to src sizePerThread.
-              readIdx[smemIdx] =
-                  b.urem(readIdx[smemIdx], b.i32_val(smemShape[smemIdx]));
-            }
-          }
           Value readOffset =
-              linearize(rewriter, loc, readIdx, smemShape, smemOrder);
+              linearize(rewriter, loc, readIndices[j], smemShape, smemOrder);
           Value readPtr =
               b.gep(smemBases[i].getType(), elemTy, smemBases[i], readOffset);
           resultVals[j] = b.load(elemTy, readPtr);
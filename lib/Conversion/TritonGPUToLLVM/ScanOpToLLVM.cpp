@@ -13,14 +13,32 @@ using ::mlir::LLVM::delinearize;
 using ::mlir::LLVM::linearize;
 using ::mlir::triton::gpu::getTotalElemsPerThread;
 
-// apply combine region to acc and cur and accumulate it into acc
+// apply combine region to acc and cur and accumulate it into acc. For a
+// segmented scan the last value of acc and cur is a segment head flag, and the
+// combination starts back from cur if it contains a segment head.
 static SmallVector<Value> accumulate(ScanLoweringHelper &helper,
                                      ConversionPatternRewriter &rewriter,
                                      ValueRange acc, ValueRange cur,
                                      Value pred = {}) {
   auto loc = helper.getLoc();
   auto &combineOp = helper.getCombineOp();
-  return applyCombineOp(loc, rewriter, combineOp, acc, cur, pred);
+  if (!helper.isSegmented() || acc.empty())
+    return applyCombineOp(loc, rewriter, combineOp, acc, cur, pred);
+  auto b = TritonLLVMOpBuilder(loc, rewriter);
+  Value curHead = cur.back();
+  SmallVector<Value> res = applyCombineOp(
+      loc, rewriter, combineOp, acc.drop_back(), cur.drop_back(), pred);
+  for (unsigned i = 0; i < res.size(); ++i)
+    res[i] = b.select(curHead, cur[i], res[i]);
+  res.push_back(b.or_(acc.back(), curHead));
+  return res;
+}
+
+static SmallVector<Value> getZeros(TritonLLVMOpBuilder &b, ValueRange values) {
+  SmallVector<Value> zeros;
+  for (Value v : values)
+    zeros.push_back(b.null(v.getType()));
+  return zeros;
 }
 
 // Scan a contiguous elements within a thread and update `srcValues` in place.
@@ -81,6 +99,62 @@ static void warpScan(SmallVector<SmallVector<Value>> &srcValues,
   }
 }
 
+// warpScan for a segmented scan whose lanes along the axis are contiguous.
+// Rather than shuffling the segment head flags along with the values, gather
+// the flags of the whole warp with a single ballot: at each step a lane only
+// combines the value of its partner if no segment starts in between.
+static void segmentedWarpScan(SmallVector<SmallVector<Value>> &srcValues,
+                              ConversionPatternRewriter &rewriter,
+                              const TargetInfoBase &targetInfo,
+                              ScanLoweringHelper &helper, Value laneId,
+                              Value laneIdAxis, unsigned warpSize) {
+  Location loc = helper.getLoc();
+  auto b = TritonLLVMOpBuilder(loc, rewriter);
+  unsigned scanElementsPerThreads = helper.getAxisNumElementsPerThread();
+  unsigned elementStride = helper.getAxisElementStride();
+  unsigned scanDim = helper.getAxisNumThreadsPerWarpWithUniqueData();
+  unsigned numValues = helper.getNumCombinedOperands();
+  assert(helper.isSegmented() && helper.getAxisThreadStride() == 1);
+  Type headsTy = int_ty(warpSize);
+  Value zero = b.int_val(warpSize, 0);
+  // Return the flags of lanes (laneId - width, laneId], in the high bits.
+  auto headsBefore = [&](Value heads, Value width) {
+    Value hi = b.sub(b.i32_val(warpSize - 1), laneId);
+    Value lo = b.sub(b.i32_val(warpSize), width);
+    if (warpSize != 32) {
+      hi = b.zext(headsTy, hi);
+      lo = b.zext(headsTy, lo);
+    }
+    return b.lshr(b.shl(heads, hi), lo);
+  };
+  for (unsigned srcIndex = 0; srcIndex < srcValues.size(); srcIndex++) {
+    unsigned elementIdx = (srcIndex / elementStride) % scanElementsPerThreads;
+    // Only consider the last element of each contiguous chunk of elements.
+    if (elementIdx != scanElementsPerThreads - 1)
+      continue;
+    SmallVector<Value> acc = srcValues[srcIndex];
+    Value heads = targetInfo.ballot(rewriter, loc, headsTy, acc.back());
+    for (unsigned i = 1; i <= scanDim / 2; i <<= 1) {
+      SmallVector<Value> shfl(numValues);
+      for (unsigned j = 0; j < numValues; ++j) {
+        shfl[j] = targetInfo.shuffleUp(rewriter, loc, acc[j], i);
+      }
+      Value mask = b.icmp_sge(laneIdAxis, b.i32_val(i));
+      SmallVector<Value> tempAcc =
+          applyCombineOp(loc, rewriter, helper.getCombineOp(), shfl,
+                         ArrayRef(acc).take_front(numValues), mask);
+      Value noHead = b.icmp_eq(headsBefore(heads, b.i32_val(i)), zero);
+      mask = b.and_(mask, noHead);
+      for (unsigned j = 0; j < numValues; ++j) {
+        acc[j] = b.select(mask, tempAcc[j], acc[j]);
+      }
+    }
+    Value width = b.add(laneIdAxis, b.i32_val(1));
+    acc.back() = b.icmp_ne(headsBefore(heads, width), zero);
+    srcValues[srcIndex] = std::move(acc);
+  }
+}
+
 // For each set of contiguous elements within a thread we store the partial
 // reduction into shared memory. Each parallel scan and each warp will store its
 // own partial reductions. The shared memory is organized as follow:
@@ -126,14 +200,16 @@ static void storeWarpAccumulator(SmallVector<SmallVector<Value>> &srcValues,
 // elements for each warp and parallel scan. Then combine the partial reduction
 // with the right elements. Within a given contiguous element chunk we update
 // all the elements by accumulating the value from the last element of the
-// reduced value from the previous lane.
+// reduced value from the previous lane. For an exclusive scan, also record in
+// `carryIns` the combination of all the elements before each chunk.
 static void AddPartialReduce(SmallVector<SmallVector<Value>> &srcValues,
                              ConversionPatternRewriter &rewriter,
                              const TargetInfoBase &targetInfo,
                              ScanLoweringHelper &helper,
                              ArrayRef<Value> smemBases,
                              ArrayRef<Type> smemTypes, Value warpId,
-                             Value laneIdAxis, Value parallelLaneId) {
+                             Value laneIdAxis, Value parallelLaneId,
+                             SmallVector<SmallVector<Value>> &carryIns) {
   Location loc = helper.getLoc();
   auto b = TritonLLVMOpBuilder(loc, rewriter);
   unsigned numParallelLane = helper.getNonAxisNumThreadsPerCTA();
@@ -218,6 +294,17 @@ static void AddPartialReduce(SmallVector<SmallVector<Value>> &srcValues,
       lastElement[i] =
           b.select(maskNotFirstLane, elem, accumulator.maskedAcc[i]);
     }
+    if (helper.isExclusive()) {
+      carryIns[srcIndex] = lastElement;
+      if (axisBlockId == 0) {
+        // Nothing comes before the first chunk of the first thread.
+        auto zeros = getZeros(b, lastElement);
+        for (unsigned i = 0; i < helper.getNumOperands(); ++i) {
+          carryIns[srcIndex][i] =
+              b.select(maskNotFirstThread, lastElement[i], zeros[i]);
+        }
+      }
+    }
     for (unsigned i = 1; i < scanElementsPerThreads; ++i) {
       pred = axisBlockId == 0 ? maskNotFirstThread : Value{};
       auto laneValue = srcValues[srcIndex - i * elementStride];
@@ -239,11 +326,13 @@ static void AddPartialReduce(SmallVector<SmallVector<Value>> &srcValues,
   }
 }
 
-static void AddPartialReduceOneWarp(SmallVector<SmallVector<Value>> &srcValues,
-                                    ConversionPatternRewriter &rewriter,
-                                    const TargetInfoBase &targetInfo,
-                                    ScanLoweringHelper &helper, Value warpId,
-                                    Value laneIdAxis, Value laneIdLast) {
+static void
+AddPartialReduceOneWarp(SmallVector<SmallVector<Value>> &srcValues,
+                        ConversionPatternRewriter &rewriter,
+                        const TargetInfoBase &targetInfo,
+                        ScanLoweringHelper &helper, Value warpId,
+                        Value laneIdAxis, Value laneIdLast,
+                        SmallVector<SmallVector<Value>> &carryIns) {
   Location loc = helper.getLoc();
   auto b = TritonLLVMOpBuilder(loc, rewriter);
   unsigned scanElementsPerThreads = helper.getAxisNumElementsPerThread();
@@ -278,6 +367,7 @@ static void AddPartialReduceOneWarp(SmallVector<SmallVector<Value>> &srcValues,
                                 parallelBlockId * parallelElementsPerThread;
     auto &accumulator = accumulators[accumulatorIndex];
     unsigned axisBlockId = (blockId / blockStride) % numScanBlocks;
+    SmallVector<Value> prevBlocks = accumulator;
     if (axisBlockId == 0) // First chunk and first block
       accumulator = srcValues[srcIndex];
     else
@@ -297,8 +387,23 @@ static void AddPartialReduceOneWarp(SmallVector<SmallVector<Value>> &srcValues,
               rewriter, loc, srcValues[srcIndex][i], laneIdLast);
       }
     } else if (numScanBlocks > 1) {
+      // A single lane holds the axis: the elements before the chunk are those
+      // of the previous blocks.
+      if (axisBlockId > 0)
+        lastElement = prevBlocks;
       accumulator = srcValues[srcIndex];
     }
+    if (helper.isExclusive()) {
+      carryIns[srcIndex] = lastElement;
+      if (axisBlockId == 0) {
+        // Nothing comes before the first chunk of the first thread.
+        auto zeros = getZeros(b, lastElement);
+        for (unsigned i = 0; i < helper.getNumOperands(); ++i) {
+          carryIns[srcIndex][i] =
+              b.select(maskFirstThread, zeros[i], lastElement[i]);
+        }
+      }
+    }
     for (unsigned i = 1; i < scanElementsPerThreads; ++i) {
       auto laneValue = srcValues[srcIndex - i * elementStride];
       laneValue = accumulate(helper, rewriter, lastElement, laneValue);
@@ -319,6 +424,44 @@ static void AddPartialReduceOneWarp(SmallVector<SmallVector<Value>> &srcValues,
   }
 }
 
+// Turn the inclusive scan into an exclusive one. Within each chunk of
+// contiguous elements every element takes the value of the previous one, and
+// the first element takes the carry-in of the chunk. Segment heads start back
+// from zero.
+static void makeExclusive(SmallVector<SmallVector<Value>> &srcValues,
+                          ArrayRef<SmallVector<Value>> carryIns,
+                          ArrayRef<Value> heads,
+                          ConversionPatternRewriter &rewriter,
+                          ScanLoweringHelper &helper) {
+  auto b = TritonLLVMOpBuilder(helper.getLoc(), rewriter);
+  unsigned scanElementsPerThreads = helper.getAxisNumElementsPerThread();
+  unsigned elementStride = helper.getAxisElementStride();
+  unsigned numValues = helper.getNumCombinedOperands();
+  for (unsigned srcIndex = 0; srcIndex < srcValues.size(); srcIndex++) {
+    unsigned elementIdx = (srcIndex / elementStride) % scanElementsPerThreads;
+    // Only consider the last element of each contiguous chunk of elements.
+    if (elementIdx != scanElementsPerThreads - 1)
+      continue;
+    for (unsigned j = 0; j < numValues; ++j) {
+      for (unsigned i = 0; i + 1 < scanElementsPerThreads; ++i) {
+        srcValues[srcIndex - i * elementStride][j] =
+            srcValues[srcIndex - (i + 1) * elementStride][j];
+      }
+      unsigned first = srcIndex - (scanElementsPerThreads - 1) * elementStride;
+      srcValues[first][j] = carryIns[srcIndex][j];
+    }
+  }
+  if (!helper.isSegmented())
+    return;
+  auto zeros = getZeros(b, ArrayRef(srcValues[0]).take_front(numValues));
+  for (unsigned srcIndex = 0; srcIndex < srcValues.size(); srcIndex++) {
+    for (unsigned j = 0; j < numValues; ++j) {
+      srcValues[srcIndex][j] =
+          b.select(heads[srcIndex], zeros[j], srcValues[srcIndex][j]);
+    }
+  }
+}
+
 namespace {
 struct ScanOpConversion
     : public ConvertTritonGPUReduceScanToLLVMPattern<triton::ScanOp> {
@@ -479,6 +622,7 @@ ScanOpConversion::emitFastScan(triton::ScanOp op, triton::ScanOpAdaptor adaptor,
   Value warpSize = b.i32_val(iWarpSize);
   Value warpId = b.udiv(threadId, warpSize);
   Value laneId = b.urem(threadId, warpSize);
+  Value hwLaneId = laneId;
 
   // Clamp the lane ID to just threads with unique data within a warp.
   LinearLayout layout =
@@ -508,11 +652,25 @@ ScanOpConversion::emitFastScan(triton::ScanOp op, triton::ScanOpAdaptor adaptor,
         flipSrcValues(loc, op, rewriter, targetInfo, srcValues, iWarpSize);
   }
 
+  // Keep the segment heads of each element, the scan overwrites them.
+  SmallVector<Value> heads;
+  if (helper.isSegmented()) {
+    for (auto &values : srcValues)
+      heads.push_back(values.back());
+  }
+  // Combination of all the elements before each chunk of contiguous elements,
+  // indexed by the last element of the chunk. Only for exclusive scans.
+  SmallVector<SmallVector<Value>> carryIns(srcValues.size());
+
   // Scan contiguous elements in a thread and update `srcValues`.
   scanThreadContiguousElements(srcValues, rewriter, helper);
   // Apply warp level scan to the last element of each chunk of contiguous
   // elements.
-  warpScan(srcValues, rewriter, targetInfo, helper, laneIdAxis);
+  if (helper.isSegmented() && helper.getAxisThreadStride() == 1)
+    segmentedWarpScan(srcValues, rewriter, targetInfo, helper, hwLaneId,
+                      laneIdAxis, iWarpSize);
+  else
+    warpScan(srcValues, rewriter, targetInfo, helper, laneIdAxis);
 
   if (axisNumWarps > 1) {
     // Slow path for the case where there are multiple warps with unique data on
@@ -533,7 +691,8 @@ ScanOpConversion::emitFastScan(triton::ScanOp op, triton::ScanOpAdaptor adaptor,
     // warpId. Then update each chunk of contiguous elements by adding the
     // accumulated value from the previous lane.
     AddPartialReduce(srcValues, rewriter, targetInfo, helper, smemBases,
-                     smemTypes, warpIdAxis, laneIdAxis, flatIdParallel);
+                     smemTypes, warpIdAxis, laneIdAxis, flatIdParallel,
+                     carryIns);
   } else if (srcValues.size() > 1) {
     // Fast path for the case where there is only one warp with unique data on
     // the axis.
@@ -544,8 +703,25 @@ ScanOpConversion::emitFastScan(triton::ScanOp op, triton::ScanOpAdaptor adaptor,
     auto laneIdLast = linearize(rewriter, loc, multiDimLaneId, threadsPerWarp,
                                 triton::gpu::getOrder(helper.getEncoding()));
     AddPartialReduceOneWarp(srcValues, rewriter, targetInfo, helper, warpIdAxis,
-                            laneIdAxis, laneIdLast);
-  } // else axisNumWarps == 1 and srcValues.size() == 1, nothing to do.
+                            laneIdAxis, laneIdLast, carryIns);
+  } else if (helper.isExclusive()) {
+    // A single element per thread: the carry-in is the value of the previous
+    // lane.
+    unsigned numValues = helper.getNumCombinedOperands();
+    Value maskFirstLane = b.icmp_eq(laneIdAxis, b.i32_val(0));
+    auto zeros = getZeros(b, ArrayRef(srcValues[0]).take_front(numValues));
+    for (unsigned i = 0; i < numValues; ++i) {
+      Value prev = targetInfo.shuffleUp(rewriter, loc, srcValues[0][i],
+                                        helper.getAxisThreadStride());
+      carryIns[0].push_back(b.select(maskFirstLane, zeros[i], prev));
+    }
+  } // else an inclusive scan with a single element per thread, nothing to do.
+
+  if (helper.isExclusive())
+    makeExclusive(srcValues, carryIns, heads, rewriter, helper);
+  // The result for the segment heads is the heads themselves.
+  for (unsigned i = 0; i < heads.size(); ++i)
+    srcValues[i].back() = heads[i];
 
   auto transpose = [](const SmallVector<SmallVector<Value>> &v) {
     assert(v.size() > 0 && v[0].size() > 0);
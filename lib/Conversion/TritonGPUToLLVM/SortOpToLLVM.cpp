@@ -0,0 +1,337 @@
+#include "triton/Analysis/Utility.h"
+#include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+using namespace mlir::triton::gpu;
+
+namespace {
+
+// High-level description of the algorithm:
+//
+// Both ops are lowered to compare-and-swap stages of a bitonic network along
+// the axis. A stage compares each element with the one whose index along the
+// axis differs by bit `j`, and keeps the smaller or the larger one depending
+// on its position and on the direction of its block.
+//
+// `SortLoweringHelper::isSupported` checks that every bit of the axis is the
+// image of a single register, lane or warp basis, so the partner of an element
+// is held
+//
+//   - by another register of the same thread, and the stage is a select,
+//   - by the same register of another lane, and the stage is a shuffle,
+//   - by the same register of another warp, and the stage is a round trip
+//     through shared memory.
+//
+// With a layout that puts the axis within a warp, only the last case needs
+// shared memory, and only for the few stages that touch the warp bits.
+//
+// The top-k can also return the position of each element. The positions then
+// go through the same stages as the values and are swapped along with them.
+class BitonicEmitter {
+public:
+  BitonicEmitter(Operation *op, RankedTensorType srcTy, Type elemTy, int axis,
+                 bool isUnsigned, const TargetInfoBase &targetInfo,
+                 ConversionPatternRewriter &rewriter)
+      : op(op), loc(op->getLoc()), srcTy(srcTy), elemTy(elemTy), axis(axis),
+        isUnsigned(isUnsigned), targetInfo(targetInfo), rewriter(rewriter) {
+    LinearLayout layout =
+        toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+    StringAttr kAxis = rewriter.getStringAttr("dim" + Twine(axis));
+    numBits = llvm::Log2_64(srcTy.getShape()[axis]);
+    axisBits.resize(numBits);
+    for (StringAttr inDim : layout.getInDimNames()) {
+      for (int i = 0; i < layout.getInDimSizeLog2(inDim); ++i) {
+        int32_t value = layout.getBasis(inDim, i, kAxis);
+        if (value != 0)
+          axisBits[llvm::Log2_32(value)] = {inDim, i};
+      }
+    }
+
+    indices = emitIndices(loc, rewriter, targetInfo, srcTy.getEncoding(),
+                          srcTy, /*withCTAOffset=*/false);
+    shapePerCTA = convertType<unsigned>(getShapePerCTA(srcTy));
+    // The axis is the most minor dimension, make it the fastest varying one
+    // in shared memory so that partners are `offset ^ (1 << j)`.
+    for (int dim = srcTy.getRank() - 1; dim >= 0; --dim)
+      smemOrder.push_back(dim);
+  }
+
+  // Sort every row along the axis.
+  void sort(SmallVector<Value> &values, bool descending) {
+    SmallVector<Value> noPositions;
+    for (unsigned stage = 1; stage <= numBits; ++stage) {
+      // Blocks of 2^stage elements alternate between ascending and descending
+      // order, except for the last stage.
+      std::optional<unsigned> dirBit;
+      if (stage < numBits)
+        dirBit = stage;
+      for (int j = stage - 1; j >= 0; --j)
+        compareAndSwap(values, noPositions, j, dirBit, descending);
+    }
+  }
+
+  // Move the `k` largest elements of every row, in descending order, to its
+  // first `k` positions. The other positions are left with unspecified values.
+  // If `positions` is not empty, it holds the position of each element along
+  // the axis, which is moved along with it.
+  void topk(SmallVector<Value> &values, SmallVector<Value> &positions,
+            unsigned k) {
+    unsigned logK = llvm::Log2_32(k);
+    // Sort blocks of k elements, in alternating order, or the whole row in
+    // descending order if k is its size.
+    for (unsigned stage = 1; stage <= logK; ++stage) {
+      std::optional<unsigned> dirBit;
+      if (stage < numBits)
+        dirBit = stage;
+      for (int j = stage - 1; j >= 0; --j)
+        compareAndSwap(values, positions, j, dirBit, /*descending=*/true);
+    }
+    // Pair an ascending block with a descending one: their elementwise maxima
+    // are the k largest elements of both, as a bitonic sequence, which is
+    // then sorted in the order its next pairing needs. Every level halves the
+    // number of blocks that hold candidates.
+    for (unsigned level = logK; level < numBits; ++level) {
+      compareAndSwap(values, positions, level, std::nullopt,
+                     /*descending=*/true);
+      std::optional<unsigned> dirBit;
+      if (level + 1 < numBits)
+        dirBit = level + 1;
+      for (int j = logK - 1; j >= 0; --j)
+        compareAndSwap(values, positions, j, dirBit, /*descending=*/true);
+    }
+  }
+
+  // Get the position of each element along the axis, as i32.
+  SmallVector<Value> getPositions() {
+    SmallVector<Value> positions;
+    for (auto &idx : indices)
+      positions.push_back(idx[axis]);
+    return positions;
+  }
+
+  // Store the values, of type `type`, to shared memory, and load them back
+  // with the layout of `dstTy`, which has the same encoding but fewer elements
+  // along the axis.
+  SmallVector<Value> loadPrefix(ArrayRef<Value> values, Type type,
+                                RankedTensorType dstTy) {
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    Value smemBase = getSmemBase();
+    for (auto [value, offset] : llvm::zip(values, getOffsets()))
+      b.store(value, b.gep(smemBase.getType(), type, smemBase, offset));
+    b.barrier();
+    auto dstIndices =
+        emitIndices(loc, rewriter, targetInfo, dstTy.getEncoding(), dstTy,
+                    /*withCTAOffset=*/false);
+    SmallVector<Value> results;
+    for (auto &idx : dstIndices) {
+      Value offset =
+          LLVM::linearize(rewriter, loc, idx, shapePerCTA, smemOrder);
+      results.push_back(
+          b.load(type, b.gep(smemBase.getType(), type, smemBase, offset)));
+    }
+    // The next round trip through shared memory overwrites the same
+    // locations.
+    b.barrier();
+    return results;
+  }
+
+private:
+  Operation *op;
+  Location loc;
+  RankedTensorType srcTy;
+  Type elemTy;
+  int axis;
+  bool isUnsigned;
+  const TargetInfoBase &targetInfo;
+  ConversionPatternRewriter &rewriter;
+
+  unsigned numBits;
+  // The register, lane or warp bit that flips each bit of the axis.
+  SmallVector<std::pair<StringAttr, int>> axisBits;
+  SmallVector<SmallVector<Value>> indices;
+  SmallVector<unsigned> shapePerCTA;
+  SmallVector<unsigned> smemOrder;
+  SmallVector<Value> offsets;
+  Value smemBase;
+
+  Value getSmemBase() {
+    if (!smemBase)
+      smemBase = LLVM::getSharedMemoryBase(loc, rewriter, targetInfo, op);
+    return smemBase;
+  }
+
+  ArrayRef<Value> getOffsets() {
+    if (offsets.empty()) {
+      for (auto &idx : indices)
+        offsets.push_back(
+            LLVM::linearize(rewriter, loc, idx, shapePerCTA, smemOrder));
+    }
+    return offsets;
+  }
+
+  Value isBitSet(Value index, unsigned bit) {
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    return b.icmp_ne(b.and_(index, b.i32_val(1 << bit)), b.i32_val(0));
+  }
+
+  // Maps the sign-magnitude bits of a float, held in an integer (fp8 types
+  // are lowered to i8), to an integer with the same signed order.
+  Value getOrderedBits(Value bits) {
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    unsigned width = bits.getType().getIntOrFloatBitWidth();
+    Value sign = b.ashr(bits, b.int_val(width, width - 1));
+    return b.xor_(bits, b.lshr(sign, b.int_val(width, 1)));
+  }
+
+  Value greaterThan(Value lhs, Value rhs) {
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    if (isa<FloatType>(lhs.getType()))
+      return b.fcmp_ogt(lhs, rhs);
+    if (isa<FloatType>(srcTy.getElementType()))
+      return b.icmp_sgt(getOrderedBits(lhs), getOrderedBits(rhs));
+    return isUnsigned ? b.icmp_ugt(lhs, rhs) : b.icmp_sgt(lhs, rhs);
+  }
+
+  // Get, for each register, the value of its partner along bit `j` of the
+  // axis. The values are of type `type`.
+  SmallVector<Value> getPartners(ArrayRef<Value> values, Type type,
+                                 unsigned j) {
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    auto [inDim, pos] = axisBits[j];
+    SmallVector<Value> partners(values.size());
+    if (inDim.getValue() == "register") {
+      for (unsigned r = 0; r < values.size(); ++r)
+        partners[r] = values[r ^ (1u << pos)];
+    } else if (inDim.getValue() == "lane") {
+      for (unsigned r = 0; r < values.size(); ++r)
+        partners[r] =
+            targetInfo.shuffleXor(rewriter, loc, values[r], 1 << pos);
+    } else {
+      assert(inDim.getValue() == "warp" && "unexpected layout");
+      Value base = getSmemBase();
+      for (auto [value, offset] : llvm::zip(values, getOffsets()))
+        b.store(value, b.gep(base.getType(), type, base, offset));
+      b.barrier();
+      for (auto [r, offset] : llvm::enumerate(getOffsets())) {
+        Value partnerOffset = b.xor_(offset, b.i32_val(1 << j));
+        partners[r] =
+            b.load(type, b.gep(base.getType(), type, base, partnerOffset));
+      }
+      // The next stage through shared memory overwrites the same locations.
+      b.barrier();
+    }
+    return partners;
+  }
+
+  // Compare each element with its partner along bit `j` of the axis. The
+  // lower of the two ends up with the smaller element if its block is in
+  // ascending order, that is if bit `dirBit` of its index is clear, or if
+  // there is no `dirBit` and `descending` is false. The `positions`, if any,
+  // are swapped along with the values.
+  void compareAndSwap(SmallVector<Value> &values,
+                      SmallVector<Value> &positions, unsigned j,
+                      std::optional<unsigned> dirBit, bool descending) {
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    SmallVector<Value> partners = getPartners(values, elemTy, j);
+    SmallVector<Value> partnerPositions;
+    if (!positions.empty())
+      partnerPositions = getPartners(positions, i32_ty, j);
+    for (unsigned r = 0; r < values.size(); ++r) {
+      Value index = indices[r][axis];
+      Value isUpper = isBitSet(index, j);
+      Value left = b.select(isUpper, partners[r], values[r]);
+      Value right = b.select(isUpper, values[r], partners[r]);
+      Value flip = dirBit ? isBitSet(index, *dirBit) : b.i1_val(descending);
+      // Both elements of a pair evaluate the same comparison, so that they
+      // agree on the outcome even for unordered values.
+      Value swap = b.xor_(greaterThan(left, right), flip);
+      values[r] = b.select(swap, partners[r], values[r]);
+      if (!positions.empty())
+        positions[r] = b.select(swap, partnerPositions[r], positions[r]);
+    }
+  }
+};
+
+class SortOpConversion : public ConvertOpToLLVMPattern<SortOp> {
+public:
+  SortOpConversion(LLVMTypeConverter &typeConverter,
+                   const TargetInfoBase &targetInfo, PatternBenefit benefit)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
+
+  LogicalResult
+  matchAndRewrite(SortOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    SortLoweringHelper helper(op);
+    if (!helper.isSupported())
+      return rewriter.notifyMatchFailure(op, "unsupported layout for sort");
+    RankedTensorType srcTy = op.getSrc().getType();
+    SmallVector<Value> values =
+        unpackLLElements(op.getLoc(), adaptor.getSrc(), rewriter);
+    Type elemTy = getTypeConverter()->convertType(srcTy.getElementType());
+    BitonicEmitter emitter(op, srcTy, elemTy, op.getAxis(),
+                           op.getIsUnsigned(), targetInfo, rewriter);
+    emitter.sort(values, op.getDescending());
+    rewriter.replaceOp(op, packLLElements(op.getLoc(), getTypeConverter(),
+                                          values, rewriter, srcTy));
+    return success();
+  }
+
+private:
+  const TargetInfoBase &targetInfo;
+};
+
+class TopKOpConversion : public ConvertOpToLLVMPattern<TopKOp> {
+public:
+  TopKOpConversion(LLVMTypeConverter &typeConverter,
+                   const TargetInfoBase &targetInfo, PatternBenefit benefit)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
+
+  LogicalResult
+  matchAndRewrite(TopKOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    SortLoweringHelper helper(op);
+    if (!helper.isSupported())
+      return rewriter.notifyMatchFailure(op, "unsupported layout for topk");
+    RankedTensorType srcTy = op.getSrc().getType();
+    SmallVector<Value> values =
+        unpackLLElements(op.getLoc(), adaptor.getSrc(), rewriter);
+    Type elemTy = getTypeConverter()->convertType(srcTy.getElementType());
+    BitonicEmitter emitter(op, srcTy, elemTy, op.getAxis(),
+                           op.getIsUnsigned(), targetInfo, rewriter);
+    SmallVector<Value> positions;
+    if (op.getIndices())
+      positions = emitter.getPositions();
+    emitter.topk(values, positions, op.getK());
+    RankedTensorType resultTy = op.getResult().getType();
+    SmallVector<Value> results = emitter.loadPrefix(values, elemTy, resultTy);
+    SmallVector<Value> replacements = {packLLElements(
+        op.getLoc(), getTypeConverter(), results, rewriter, resultTy)};
+    if (Value indices = op.getIndices()) {
+      auto indicesTy = cast<RankedTensorType>(indices.getType());
+      SmallVector<Value> indicesResults =
+          emitter.loadPrefix(positions, i32_ty, indicesTy);
+      replacements.push_back(packLLElements(op.getLoc(), getTypeConverter(),
+                                            indicesResults, rewriter,
+                                            indicesTy));
+    }
+    rewriter.replaceOp(op, replacements);
+    return success();
+  }
+
+private:
+  const TargetInfoBase &targetInfo;
+};
+
+} // namespace
+
+void mlir::triton::populateSortOpToLLVMPatterns(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    const TargetInfoBase &targetInfo, PatternBenefit benefit) {
+  patterns.add<SortOpConversion, TopKOpConversion>(typeConverter, targetInfo,
+                                                   benefit);
+}
@@ -537,7 +537,8 @@ struct TritonScanPattern : public OpConversionPattern<triton::ScanOp> {
   matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     auto newScan = rewriter.create<triton::ScanOp>(
-        op.getLoc(), adaptor.getOperands(), adaptor.getAxis(), op.getReverse());
+        op.getLoc(), adaptor.getOperands(), adaptor.getAxis(), op.getReverse(),
+        op.getSegmented(), op.getExclusive());
     addNamedAttrs(newScan, adaptor.getAttributes());
 
     auto &newCombineOp = newScan.getCombineOp();
@@ -548,6 +549,79 @@ struct TritonScanPattern : public OpConversionPattern<triton::ScanOp> {
   }
 };
 
+// The lowering of tt.sort and tt.topk keeps the sorted axis within a CTA.
+// Returns `src`, or its conversion to a blocked layout that replicates it
+// across the CTAs that would split the axis.
+static Value convertToSortLayout(Value src, int axis,
+                                 const TritonGPUTypeConverter *typeConverter,
+                                 ConversionPatternRewriter &rewriter) {
+  auto srcType = cast<RankedTensorType>(src.getType());
+  Attribute encoding = srcType.getEncoding();
+  if (getCTASplitNum(encoding)[axis] == 1)
+    return src;
+  CTALayoutAttr ctaLayout = getCTALayout(encoding);
+  SmallVector<unsigned> splitNum(ctaLayout.getCTASplitNum());
+  splitNum[axis] = 1;
+  unsigned rank = srcType.getRank();
+  SmallVector<unsigned> order(rank);
+  for (unsigned i = 0; i < rank; ++i)
+    order[i] = rank - 1 - i;
+  Attribute sortEncoding = BlockedEncodingAttr::get(
+      rewriter.getContext(), srcType.getShape(), SmallVector<unsigned>(rank, 1),
+      order, typeConverter->getNumWarps(), typeConverter->getThreadsPerWarp(),
+      CTALayoutAttr::get(rewriter.getContext(), ctaLayout.getCTAsPerCGA(),
+                         splitNum, ctaLayout.getCTAOrder()));
+  auto dstType = RankedTensorType::get(srcType.getShape(),
+                                       srcType.getElementType(), sortEncoding);
+  return rewriter.create<ConvertLayoutOp>(src.getLoc(), dstType, src);
+}
+
+struct TritonSortPattern : public OpConversionPattern<triton::SortOp> {
+  using OpConversionPattern::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SortOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Value src =
+        convertToSortLayout(adaptor.getSrc(), op.getAxis(),
+                            getTypeConverter<TritonGPUTypeConverter>(),
+                            rewriter);
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::SortOp>(
+                      op, src.getType(), src, op.getAxisAttr(),
+                      op.getDescendingAttr(), op.getIsUnsignedAttr()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
+struct TritonTopKPattern : public OpConversionPattern<triton::TopKOp> {
+  using OpConversionPattern::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::TopKOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Value src =
+        convertToSortLayout(adaptor.getSrc(), op.getAxis(),
+                            getTypeConverter<TritonGPUTypeConverter>(),
+                            rewriter);
+    // The results have the encoding of the source, with k elements along the
+    // axis.
+    auto srcType = cast<RankedTensorType>(src.getType());
+    auto resultShape = op.getResult().getType().getShape();
+    Type retType = RankedTensorType::get(
+        resultShape, srcType.getElementType(), srcType.getEncoding());
+    Type indicesType;
+    if (op.getIndices())
+      indicesType = RankedTensorType::get(
+          resultShape, rewriter.getI32Type(), srcType.getEncoding());
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::TopKOp>(
+                      op, retType, indicesType, src, op.getKAttr(),
+                      op.getAxisAttr(), op.getIsUnsignedAttr()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
 class TritonFuncOpPattern : public OpConversionPattern<triton::FuncOp> {
 public:
   using OpConversionPattern::OpConversionPattern;
@@ -617,7 +691,7 @@ void populateTritonPatterns(TritonGPUTypeConverter &typeConverter,
       TritonTransPattern, TritonDotPattern, TritonDescriptorGatherPattern,
       TritonDescriptorScatterPattern, GenericOpPattern<triton::LoadOp>,
       GenericOpPattern<triton::StoreOp>, GenericOpPattern<triton::HistogramOp>,
-      GenericOpPattern<triton::GatherOp>,
+      GenericOpPattern<triton::GatherOp>, TritonSortPattern, TritonTopKPattern,
       GenericOpPattern<triton::ExternElementwiseOp>,
       GenericOpPattern<triton::PrintOp>, GenericOpPattern<triton::AssertOp>,
       GenericOpPattern<triton::AtomicCASOp>,
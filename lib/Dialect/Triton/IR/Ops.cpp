@@ -449,10 +449,9 @@ template <class Op> LogicalResult verifyReduceScan(Op &op) {
 }
 
 template <class ReturnOp, class Op>
-static LogicalResult verifyRegionsImpl(Op &op) {
+static LogicalResult verifyRegionsImpl(Op &op, unsigned numCombined) {
   auto argElementTypes = op.getElementTypes();
-  const auto &operands = op.getOperands();
-  const auto numArgs = 2 * operands.size();
+  const auto numArgs = 2 * numCombined;
   auto &block = *op.getBody();
   if (block.getNumArguments() != numArgs) {
     return op.emitOpError() << "nested block must take " << numArgs
@@ -463,7 +462,7 @@ static LogicalResult verifyRegionsImpl(Op &op) {
   const auto &blockArgTypes = block.getArgumentTypes();
   for (unsigned i = 0; i < numArgs; ++i) {
     const auto &blockArgTy = blockArgTypes[i];
-    const auto &argElemTy = argElementTypes[i % operands.size()];
+    const auto &argElemTy = argElementTypes[i % numCombined];
     if (blockArgTy != argElemTy) {
       return op.emitOpError()
              << "type mismatch on combine operation. Expected argument " << i
@@ -478,9 +477,9 @@ static LogicalResult verifyRegionsImpl(Op &op) {
            << "with a ReduceReturnOp but got " << block.getTerminator();
   }
   const auto &combineResults = terminator->getOperands();
-  if (combineResults.size() != operands.size()) {
+  if (combineResults.size() != numCombined) {
     return op.emitOpError()
-           << "expected combine operation to return " << operands.size()
+           << "expected combine operation to return " << numCombined
            << " values but got " << combineResults.size();
   }
   for (unsigned i = 0; i < combineResults.size(); ++i) {
@@ -518,7 +517,7 @@ getElementTypesImpl(const Operation::operand_range &operands) {
 LogicalResult ReduceOp::verify() { return verifyReduceScan(*this); }
 
 LogicalResult ReduceOp::verifyRegions() {
-  return verifyRegionsImpl<ReduceReturnOp>(*this);
+  return verifyRegionsImpl<ReduceReturnOp>(*this, getNumOperands());
 }
 
 llvm::SmallVector<RankedTensorType> ReduceOp::getInputTypes() {
@@ -549,11 +548,13 @@ unsigned ReduceOp::getNumOperands() { return this->getOperands().size(); }
 
 //-- ScanOp --
 void ScanOp::build(OpBuilder &builder, OperationState &state,
-                   ValueRange operands, int axis, bool reverse) {
+                   ValueRange operands, int axis, bool reverse,
+                   bool segmented, bool exclusive) {
   SmallVector<Type> inferredReturnTypes;
   for (auto arg : operands)
     inferredReturnTypes.push_back(arg.getType());
-  ScanOp::build(builder, state, inferredReturnTypes, operands, axis, reverse);
+  ScanOp::build(builder, state, inferredReturnTypes, operands, axis, reverse,
+                segmented, exclusive);
 }
 
 LogicalResult
@@ -566,10 +567,42 @@ ScanOp::inferReturnTypes(MLIRContext *context, std::optional<Location> location,
   return success();
 }
 
-LogicalResult ScanOp::verify() { return verifyReduceScan(*this); }
+LogicalResult ScanOp::verify() {
+  if (failed(verifyReduceScan(*this)))
+    return failure();
+  if (getSegmented()) {
+    if (getNumOperands() < 2)
+      return emitOpError() << "segmented scan must have at least one operand "
+                              "besides the segment head flags";
+    if (!getElementTypes().back().isInteger(1))
+      return emitOpError() << "segment head flags must be of type i1";
+  }
+  return success();
+}
 
 LogicalResult ScanOp::verifyRegions() {
-  return verifyRegionsImpl<ScanReturnOp>(*this);
+  if (failed(verifyRegionsImpl<ScanReturnOp>(*this, getNumCombinedOperands())))
+    return failure();
+  if (!getExclusive())
+    return success();
+  // The first element of an exclusive scan is zero, which is only the
+  // identity of an addition: each result must add its two arguments.
+  unsigned numCombined = getNumCombinedOperands();
+  Block &block = *getBody();
+  for (auto [i, result] :
+       llvm::enumerate(block.getTerminator()->getOperands())) {
+    Operation *def = result.getDefiningOp();
+    Value lhs = block.getArgument(i);
+    Value rhs = block.getArgument(i + numCombined);
+    bool isAdd =
+        isa_and_nonnull<arith::AddIOp, arith::AddFOp>(def) &&
+        ((def->getOperand(0) == lhs && def->getOperand(1) == rhs) ||
+         (def->getOperand(0) == rhs && def->getOperand(1) == lhs));
+    if (!isAdd)
+      return emitOpError() << "exclusive scan requires a combine region that "
+                              "adds its arguments";
+  }
+  return success();
 }
 
 llvm::SmallVector<RankedTensorType> ScanOp::getInputTypes() {
@@ -582,6 +615,10 @@ llvm::SmallVector<Type> ScanOp::getElementTypes() {
 
 unsigned ScanOp::getNumOperands() { return this->getOperands().size(); }
 
+unsigned ScanOp::getNumCombinedOperands() {
+  return getNumOperands() - (getSegmented() ? 1 : 0);
+}
+
 //-- SplatOp --
 OpFoldResult SplatOp::fold(FoldAdaptor adaptor) {
   auto value = adaptor.getSrc();
@@ -1167,6 +1204,46 @@ LogicalResult GatherOp::inferReturnTypes(
   return success();
 }
 
+// -- SortOp --
+static LogicalResult verifySortAxis(Operation *op, RankedTensorType srcTy,
+                                    int axis) {
+  if (axis != srcTy.getRank() - 1)
+    return op->emitOpError("only the most minor dimension can be sorted");
+  if (!llvm::isPowerOf2_64(srcTy.getShape()[axis]))
+    return op->emitOpError("sorted dimension must be a power of two");
+  return success();
+}
+
+LogicalResult SortOp::verify() {
+  return verifySortAxis(*this, getSrc().getType(), getAxis());
+}
+
+// -- TopKOp --
+LogicalResult TopKOp::verify() {
+  RankedTensorType srcTy = getSrc().getType();
+  RankedTensorType resTy = getResult().getType();
+  if (failed(verifySortAxis(*this, srcTy, getAxis())))
+    return failure();
+  int64_t k = getK();
+  if (!llvm::isPowerOf2_64(k) || k > srcTy.getShape()[getAxis()])
+    return emitOpError("k must be a power of two no larger than the sorted "
+                       "dimension");
+  SmallVector<int64_t> shape(srcTy.getShape());
+  shape[getAxis()] = k;
+  if (resTy.getShape() != ArrayRef<int64_t>(shape))
+    return emitOpError("result must have k elements along the sorted "
+                       "dimension and the shape of the input otherwise");
+  if (resTy.getElementType() != srcTy.getElementType())
+    return emitOpError("result must have the element type of the input");
+  if (Value indices = getIndices()) {
+    auto indicesTy = cast<RankedTensorType>(indices.getType());
+    if (indicesTy.getShape() != resTy.getShape() ||
+        !indicesTy.getElementType().isInteger(32))
+      return emitOpError("indices must be i32 with the shape of the result");
+  }
+  return success();
+}
+
 // -- ExperimentalDescriptorGatherOp
 LogicalResult
 ExperimentalDescriptorGatherOp::verifyResultType(Operation *op,
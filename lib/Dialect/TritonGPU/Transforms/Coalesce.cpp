@@ -2,6 +2,7 @@
 #include <numeric>
 
 #include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Support/LLVM.h"
 #include "triton/Analysis/AxisInfo.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
@@ -157,38 +158,44 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
     // Run axis info analysis
     ModuleOp moduleOp = getOperation();
     ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
-
-    // For each i/o operation, we determine what layout
-    // the pointers should have for best memory coalescing
-    llvm::MapVector<Operation *, Attribute> layoutMap;
-    moduleOp.walk([&](Operation *curr) {
-      Value ptr = getMemAccessPtr(curr);
-      if (!ptr)
-        return;
-      // We only convert `tensor<tt.ptr<>>` load/store
-      bool isPtrTensor = false;
-      if (auto tensorType = dyn_cast<RankedTensorType>(ptr.getType()))
-        isPtrTensor = isa<PointerType>(tensorType.getElementType());
-      if (!isPtrTensor)
-        return;
-      auto mod = curr->getParentOfType<ModuleOp>();
-      int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
-      int threadsPerWarp =
-          triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
-      setCoalescedEncoding(axisInfoAnalysis, curr, numWarps, threadsPerWarp,
-                           layoutMap);
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(moduleOp);
+    int threadsPerWarp =
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(moduleOp);
+
+    // The axis info analysis is interprocedural, so it runs on the whole
+    // module. Once it has run, the rewrite of each function only reads the
+    // analysis results of that function, so the functions are coalesced in
+    // parallel.
+    SmallVector<triton::FuncOp> funcOps(moduleOp.getOps<triton::FuncOp>());
+    mlir::parallelForEach(&getContext(), funcOps, [&](triton::FuncOp funcOp) {
+      // For each i/o operation, we determine what layout
+      // the pointers should have for best memory coalescing
+      llvm::MapVector<Operation *, Attribute> layoutMap;
+      funcOp.walk([&](Operation *curr) {
+        Value ptr = getMemAccessPtr(curr);
+        if (!ptr)
+          return;
+        // We only convert `tensor<tt.ptr<>>` load/store
+        bool isPtrTensor = false;
+        if (auto tensorType = dyn_cast<RankedTensorType>(ptr.getType()))
+          isPtrTensor = isa<PointerType>(tensorType.getElementType());
+        if (!isPtrTensor)
+          return;
+        setCoalescedEncoding(axisInfoAnalysis, curr, numWarps, threadsPerWarp,
+                             layoutMap);
+      });
+
+      // For each memory op that has a layout L1:
+      // 1. Create a coalesced memory layout L2 of the pointer operands
+      // 2. Convert all operands from layout L1 to layout L2
+      // 3. Create a new memory op that consumes these operands and
+      //    produces a tensor with layout L2
+      // 4. Convert the output of this new memory op back to L1
+      // 5. Replace all the uses of the original memory op by the new one
+      for (auto &kv : layoutMap) {
+        coalesceOp(kv.second, kv.first);
+      }
     });
-
-    // For each memory op that has a layout L1:
-    // 1. Create a coalesced memory layout L2 of the pointer operands
-    // 2. Convert all operands from layout L1 to layout L2
-    // 3. Create a new memory op that consumes these operands and
-    //    produces a tensor with layout L2
-    // 4. Convert the output of this new memory op back to L1
-    // 5. Replace all the uses of the original memory op by the new one
-    for (auto &kv : layoutMap) {
-      coalesceOp(kv.second, kv.first);
-    }
   }
 };
 
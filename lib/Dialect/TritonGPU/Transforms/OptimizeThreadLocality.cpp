@@ -251,18 +251,19 @@ class TritonGPUOptimizeThreadLocalityPass
     : public impl::TritonGPUOptimizeThreadLocalityBase<
           TritonGPUOptimizeThreadLocalityPass> {
   void runOnOperation() override {
-    ModuleOp mod = getOperation();
+    triton::FuncOp funcOp = getOperation();
 
     // First try to optimize the layout of views and gathers.
     mlir::RewritePatternSet layoutPatterns(&getContext());
     layoutPatterns.add<OptimizeReshapeLayoutPattern>(&getContext());
     layoutPatterns.add<OptimizeGatherLayoutPattern>(&getContext());
-    if (mlir::applyPatternsGreedily(mod, std::move(layoutPatterns)).failed()) {
+    if (mlir::applyPatternsGreedily(funcOp, std::move(layoutPatterns))
+            .failed()) {
       signalPassFailure();
     }
 
     DenseSet<triton::ReduceOp> reduceOps;
-    mod.walk([&](triton::ReduceOp reduce) -> void {
+    funcOp.walk([&](triton::ReduceOp reduce) -> void {
       auto srcType = cast<RankedTensorType>(reduce.getOperands()[0].getType());
       auto rank = srcType.getShape().size();
       auto srcEncoding = srcType.getEncoding();
@@ -329,7 +330,7 @@ class TritonGPUOptimizeThreadLocalityPass
       auto viewOpTensorShape = getThreadLocalityOptimizedShape(reduce);
       auto viewOpTensorType = RankedTensorType::get(
           viewOpTensorShape, srcType.getElementType(), blocked3d);
-      auto slice2d = triton::gpu::SliceEncodingAttr::get(mod.getContext(), rank,
+      auto slice2d = triton::gpu::SliceEncodingAttr::get(&getContext(), rank,
                                                          blocked3d);
       // Get forOp
       assert(reduce->hasOneUse());
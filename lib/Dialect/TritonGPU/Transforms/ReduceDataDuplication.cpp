@@ -30,8 +30,8 @@ class TritonGPUReduceDataDuplicationPass
           TritonGPUReduceDataDuplicationPass> {
 public:
   void runOnOperation() override {
-    ModuleOp mod = getOperation();
-    mod.walk([&](triton::gpu::ConvertLayoutOp cvtOp) -> void {
+    triton::FuncOp funcOp = getOperation();
+    funcOp.walk([&](triton::gpu::ConvertLayoutOp cvtOp) -> void {
       OpBuilder builder(cvtOp);
       auto srcType = cast<RankedTensorType>(cvtOp.getSrc().getType());
       auto dstType = cast<RankedTensorType>(cvtOp.getType());
@@ -1425,29 +1425,24 @@ void LayoutRematerialization::hoistConvertIntoConditionals(
   rewriteSlice(slice, layout, convertOp, mapping);
 }
 
-void backwardRematerialization(ModuleOp module) {
-  module.walk([](FuncOp funcOp) {
-    LayoutRematerialization layoutRemat(funcOp);
-    layoutRemat.backwardRematerialization();
-    layoutRemat.cleanup();
-  });
+void backwardRematerialization(FuncOp funcOp) {
+  LayoutRematerialization layoutRemat(funcOp);
+  layoutRemat.backwardRematerialization();
+  layoutRemat.cleanup();
 }
 
-void hoistConvert(ModuleOp module) {
-  SmallVector<ConvertLayoutOp> convertOps;
-  module.walk([](FuncOp funcOp) {
-    LayoutRematerialization layoutRemat(funcOp);
-    layoutRemat.hoistConvertOnTopOfExtOrBroadcast();
-    layoutRemat.cleanup();
-
-    layoutRemat = LayoutRematerialization(funcOp);
-    layoutRemat.hoistConvertIntoConditionals();
-    layoutRemat.cleanup();
-
-    layoutRemat = LayoutRematerialization(funcOp);
-    layoutRemat.hoistConvertDotOperand();
-    layoutRemat.cleanup();
-  });
+void hoistConvert(FuncOp funcOp) {
+  LayoutRematerialization layoutRemat(funcOp);
+  layoutRemat.hoistConvertOnTopOfExtOrBroadcast();
+  layoutRemat.cleanup();
+
+  layoutRemat = LayoutRematerialization(funcOp);
+  layoutRemat.hoistConvertIntoConditionals();
+  layoutRemat.cleanup();
+
+  layoutRemat = LayoutRematerialization(funcOp);
+  layoutRemat.hoistConvertDotOperand();
+  layoutRemat.cleanup();
 }
 } // namespace
 
@@ -1458,45 +1453,43 @@ public:
   // Cleanup convert ops.
   void cleanupConvertOps() {
     MLIRContext *context = &getContext();
-    ModuleOp m = getOperation();
+    FuncOp funcOp = getOperation();
     RewritePatternSet cleanUpPatterns(context);
     ConvertLayoutOp::getCanonicalizationPatterns(cleanUpPatterns, context);
-    if (applyPatternsGreedily(m, std::move(cleanUpPatterns)).failed()) {
+    if (applyPatternsGreedily(funcOp, std::move(cleanUpPatterns)).failed()) {
       signalPassFailure();
     }
 
     LLVM_DEBUG({
-      DBGS() << "Module after canonicalizing:\n";
-      m.dump();
+      DBGS() << "Function after canonicalizing:\n";
+      funcOp.dump();
     });
   }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
-    ModuleOp m = getOperation();
+    FuncOp funcOp = getOperation();
 
     // 1. Propagate layout forward starting from "anchor" ops.
-    m.walk([](FuncOp funcOp) {
-      LayoutPropagation layoutPropagation(funcOp);
-      layoutPropagation.initAnchorLayout();
-      layoutPropagation.propagateLayout();
-      layoutPropagation.resolveConflicts();
-      layoutPropagation.rewrite();
-    });
+    LayoutPropagation layoutPropagation(funcOp);
+    layoutPropagation.initAnchorLayout();
+    layoutPropagation.propagateLayout();
+    layoutPropagation.resolveConflicts();
+    layoutPropagation.rewrite();
 
     LLVM_DEBUG({
-      DBGS() << "Module after propagating layouts forward:\n";
-      m.dump();
+      DBGS() << "Function after propagating layouts forward:\n";
+      funcOp.dump();
     });
 
     cleanupConvertOps();
 
     // 2. For remaining convert ops, try to rematerialize the slice of producer
     // operation to avoid having to convert.
-    backwardRematerialization(m);
+    backwardRematerialization(funcOp);
     LLVM_DEBUG({
-      DBGS() << "Module after backward remat:\n";
-      m.dump();
+      DBGS() << "Function after backward remat:\n";
+      funcOp.dump();
     });
 
     // Cleanup dummy converts created during backward remat.
@@ -1504,10 +1497,10 @@ public:
 
     // 3. For remaining converts, try to hoist them above cast generating larger
     // size types in order to reduce the cost of the convert op.
-    hoistConvert(m);
+    hoistConvert(funcOp);
     LLVM_DEBUG({
-      DBGS() << "Module after hoisting converts:\n";
-      m.dump();
+      DBGS() << "Function after hoisting converts:\n";
+      funcOp.dump();
     });
 
     // 4. Apply clean up patterns to remove remove dead convert and dead code
@@ -1517,12 +1510,12 @@ public:
     scf::ForOp::getCanonicalizationPatterns(cleanUpPatterns2, context);
     scf::IfOp::getCanonicalizationPatterns(cleanUpPatterns2, context);
     ConvertLayoutOp::getCanonicalizationPatterns(cleanUpPatterns2, context);
-    if (applyPatternsGreedily(m, std::move(cleanUpPatterns2)).failed()) {
+    if (applyPatternsGreedily(funcOp, std::move(cleanUpPatterns2)).failed()) {
       signalPassFailure();
     }
     LLVM_DEBUG({
-      DBGS() << "Module after final cleanups:\n";
-      m.dump();
+      DBGS() << "Function after final cleanups:\n";
+      funcOp.dump();
     });
   }
 };
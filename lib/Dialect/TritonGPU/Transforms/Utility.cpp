@@ -466,12 +466,23 @@ static bool isSingleValue(Value value) {
   return true;
 }
 
+// Sort only supports blocked encodings that keep the sorted axis within a
+// CTA.
+static bool isSortEncoding(Operation *op, Attribute encoding) {
+  int axis = isa<triton::SortOp>(op) ? cast<triton::SortOp>(op).getAxis()
+                                     : cast<triton::TopKOp>(op).getAxis();
+  return isa<triton::gpu::BlockedEncodingAttr>(encoding) &&
+         triton::gpu::getCTASplitNum(encoding)[axis] == 1;
+}
+
 Attribute inferSrcEncoding(Operation *op, Attribute encoding) {
   if (isa<triton::ScanOp>(op)) {
     // Scan only supports blocked encoding at the moment.
     if (!isa<triton::gpu::BlockedEncodingAttr>(encoding))
       return {};
   }
+  if (isa<triton::SortOp, triton::TopKOp>(op) && !isSortEncoding(op, encoding))
+    return {};
   if (op->hasTrait<mlir::OpTrait::SameOperandsAndResultEncoding>() ||
       op->hasTrait<mlir::OpTrait::SameLoadStoreOperandsAndResultEncoding>() ||
       op->hasTrait<mlir::OpTrait::Elementwise>() ||
@@ -503,6 +514,8 @@ Attribute inferDstEncoding(Operation *op, Attribute encoding) {
     if (!isa<triton::gpu::BlockedEncodingAttr>(encoding))
       return {};
   }
+  if (isa<triton::SortOp, triton::TopKOp>(op) && !isSortEncoding(op, encoding))
+    return {};
   if (op->hasTrait<mlir::OpTrait::SameOperandsAndResultEncoding>() ||
       op->hasTrait<mlir::OpTrait::SameLoadStoreOperandsAndResultEncoding>() ||
       op->hasTrait<mlir::OpTrait::Elementwise>() ||
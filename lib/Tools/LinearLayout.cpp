@@ -1,7 +1,10 @@
 #include "triton/Tools/LinearLayout.h"
 
+#include <atomic>
 #include <cstdint>
-#include <set>
+#include <iterator>
+#include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "mlir/IR/BuiltinAttributes.h"
@@ -10,7 +13,9 @@
 #include "triton/Tools/StrUtil.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetOperations.h"
+#include "llvm/ADT/bit.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MathExtras.h"
 
 #define DEBUG_TYPE "linear_layout"
@@ -93,42 +98,49 @@ std::unique_ptr<uint64_t[]> getMatrix(const LinearLayout &layout) {
   //  | L(0,1)[1] L(0,2)[1] L(1,0)[1] L(2,0)[1] | = | 0b1000 |
   //  |    ↓         ↓         ↓         ↓      |
   //
+  // The layout already stores the columns bit-packed, so we only transpose
+  // them.
+  //
   // Note `new uint64_t[n]()` is zero-initialized, but `new uint64_t[n]` is not.
   std::unique_ptr<uint64_t[]> m(new uint64_t[numRows]());
-  int r = 0;
-  for (StringAttr outDim : layout.getOutDimNames()) {
-    int c = 0;
-    for (StringAttr inDim : layout.getInDimNames()) {
-      for (int i = 0; i < layout.getInDimSizeLog2(inDim); i++) {
-        uint64_t basis = layout.getBasis(inDim, i, outDim);
-        for (int j = 0; j < layout.getOutDimSizeLog2(outDim); j++) {
-          m[r + j] |= ((basis >> j) & 1) << c;
-        }
-        c++;
-      }
+  for (auto [c, column] : llvm::enumerate(layout.getBasisMasks())) {
+    for (uint64_t bits = column; bits != 0; bits &= bits - 1) {
+      m[__builtin_ctzll(bits)] |= uint64_t(1) << c;
     }
-    r += layout.getOutDimSizeLog2(outDim);
   }
-
   return m;
 }
 
-// Compute the rank of the matrix formed by taking the bases for the given
-// outDim as columns.  In other words, finds the number of linearly-independent
-// bases for this output dimension.
-int getMatrixRank(std::unique_ptr<uint64_t[]> m, int numRows, int numCols) {
-  // stride is specified in number of 64-bit words per row, and we pack our
-  // matrix so that there's only one uint64_t per row.
-  assert(numCols <= 64);
-  f2reduce::inplace_rref_strided(m.get(), numRows, numCols, /*stride=*/1);
-
-  // The rank of the reduced matrix is simply the number of nonzero rows.
-  int rank = 0;
-  for (int i = 0; i < numRows; i++) {
-    if (m[i] != 0)
-      rank++;
+// Returns a mask of the columns that are not a linear combination of the
+// columns before them.  These are the pivot columns of the matrix's reduced
+// row echelon form, and their number is the matrix's rank.
+//
+// Rather than running f2reduce on the transposed matrix, this keeps an xor
+// basis of the columns seen so far, indexed by their highest set bit, and
+// reduces each new column against it.
+uint64_t getPivotColumns(ArrayRef<uint64_t> columns) {
+  assert(columns.size() <= 64 && "LinearLayout too large");
+  uint64_t reduced[64] = {};
+  uint64_t pivots = 0;
+  for (auto [c, column] : llvm::enumerate(columns)) {
+    for (uint64_t bits = column; bits != 0;) {
+      unsigned top = llvm::Log2_64(bits);
+      if (reduced[top] == 0) {
+        reduced[top] = bits;
+        pivots |= uint64_t(1) << c;
+        break;
+      }
+      bits ^= reduced[top];
+    }
   }
-  return rank;
+  return pivots;
+}
+
+// Returns a mask of the low `n` bits, for n <= 64.  Shifting a uint64_t by 64
+// is undefined, so the full mask is special-cased.
+uint64_t lowBitsMask(unsigned n) {
+  assert(n <= 64 && "LinearLayout too large");
+  return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
 }
 
 template <typename T, typename U>
@@ -186,6 +198,147 @@ void assertCommonDimsSameOrder(T &&aDims, U &&bDims) {
 }
 } // anonymous namespace
 
+// Memoizes the results of the LinearLayout operations that are computed over
+// and over while lowering layout conversions. Each thread has its own cache,
+// so that passes running on several functions in parallel don't contend on a
+// lock. Layouts are keyed by the interned StringAttrs that name their dims
+// rather than by the names themselves. The result of an operation only has
+// dims of its operands, so a cached result is valid whenever its key matches,
+// even if it was computed in another MLIRContext whose attributes happen to
+// have the same addresses. The least recently used results are evicted once
+// the cache is full.
+class LayoutOpCache {
+public:
+  static LayoutOpCache &get() {
+    static thread_local LayoutOpCache cache;
+    return cache;
+  }
+
+  template <typename ComputeFn>
+  std::optional<LinearLayout> getOrCompute(LayoutCacheKind kind,
+                                           ArrayRef<const LinearLayout *> ins,
+                                           ArrayRef<StringAttr> dimNames,
+                                           ComputeFn compute) {
+    Key key = getKey(kind, ins, dimNames);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+      recordLayoutCacheLookup(kind, /*hit=*/true);
+      lru.splice(lru.begin(), lru, it->second);
+      return it->second->second;
+    }
+    recordLayoutCacheLookup(kind, /*hit=*/false);
+    std::optional<LinearLayout> result = compute();
+    assert(hasOnlyDimsOf(result, ins) && "result must only have operand dims");
+
+    lru.emplace_front(key, result);
+    entries[std::move(key)] = lru.begin();
+    if (lru.size() > kMaxEntries) {
+      entries.erase(lru.back().first);
+      lru.pop_back();
+    }
+    return result;
+  }
+
+private:
+  static constexpr size_t kMaxEntries = 1 << 12;
+
+  // The operation kind, followed by the bases, out-dims and surjectivity of
+  // each operand, and the extra dims of the operation.  Dims are stored as the
+  // addresses of their interned StringAttrs.
+  using Key = SmallVector<uint64_t, 32>;
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      return llvm::hash_combine_range(key.begin(), key.end());
+    }
+  };
+
+  static uint64_t getDimKey(StringAttr dim) {
+    return reinterpret_cast<uintptr_t>(dim.getAsOpaquePointer());
+  }
+
+  static Key getKey(LayoutCacheKind kind, ArrayRef<const LinearLayout *> ins,
+                    ArrayRef<StringAttr> dimNames) {
+    Key key;
+    key.push_back(static_cast<uint64_t>(kind));
+    for (const LinearLayout *layout : ins) {
+      key.push_back(layout->getBases().size());
+      for (const auto &[inDim, inDimBases] : layout->getBases()) {
+        key.push_back(getDimKey(inDim));
+        key.push_back(inDimBases.size());
+        for (const auto &basis : inDimBases)
+          for (int32_t b : basis)
+            key.push_back(static_cast<uint32_t>(b));
+      }
+      key.push_back(layout->outDims.size());
+      for (const auto &[outDim, size] : layout->outDims) {
+        key.push_back(getDimKey(outDim));
+        key.push_back(size);
+      }
+      key.push_back(layout->isSurjective());
+    }
+    for (StringAttr dim : dimNames)
+      key.push_back(getDimKey(dim));
+    return key;
+  }
+
+  [[maybe_unused]] static bool
+  hasOnlyDimsOf(const std::optional<LinearLayout> &result,
+                ArrayRef<const LinearLayout *> ins) {
+    if (!result)
+      return true;
+    SmallDenseSet<StringAttr> dims;
+    for (const LinearLayout *layout : ins) {
+      dims.insert(layout->getInDimNames().begin(),
+                  layout->getInDimNames().end());
+      dims.insert(layout->getOutDimNames().begin(),
+                  layout->getOutDimNames().end());
+    }
+    return llvm::all_of(result->getInDimNames(),
+                        [&](StringAttr dim) { return dims.contains(dim); }) &&
+           llvm::all_of(result->getOutDimNames(),
+                        [&](StringAttr dim) { return dims.contains(dim); });
+  }
+
+  std::list<std::pair<Key, std::optional<LinearLayout>>> lru;
+  std::unordered_map<Key, decltype(lru)::iterator, KeyHash> entries;
+};
+
+namespace {
+constexpr StringLiteral layoutCacheNames[] = {
+    "toLinearLayout", "compose", "invertAndCompose", "quotient"};
+
+struct LayoutCacheCounters {
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+};
+
+LayoutCacheCounters layoutCacheCounters[std::size(layoutCacheNames)];
+} // namespace
+
+void recordLayoutCacheLookup(LayoutCacheKind kind, bool hit) {
+  auto &counters = layoutCacheCounters[static_cast<size_t>(kind)];
+  (hit ? counters.hits : counters.misses)
+      .fetch_add(1, std::memory_order_relaxed);
+}
+
+void printLayoutCacheStatistics(llvm::raw_ostream &os) {
+  os << "===" << std::string(73, '-') << "===\n";
+  os << "  Layout cache statistics (process total)\n";
+  os << "===" << std::string(73, '-') << "===\n";
+  os << llvm::format("  %-20s %12s %12s %8s\n", "Cache", "Hits", "Misses",
+                     "Hit %");
+  for (auto [name, counters] :
+       llvm::zip(layoutCacheNames, layoutCacheCounters)) {
+    uint64_t hits = counters.hits.load(std::memory_order_relaxed);
+    uint64_t misses = counters.misses.load(std::memory_order_relaxed);
+    uint64_t lookups = hits + misses;
+    os << llvm::format("  %-20s %12llu %12llu %7.1f%%\n", name.data(),
+                       (unsigned long long)hits, (unsigned long long)misses,
+                       lookups ? 100.0 * hits / lookups : 0.0);
+  }
+}
+
 /*static*/ std::optional<LinearLayout>
 LinearLayout::tryCreate(BasesT bases,
                         ArrayRef<std::pair<StringAttr, int32_t>> outDims,
@@ -205,6 +358,7 @@ LinearLayout::LinearLayout(BasesT bases,
   for (auto [outDim, size] : outDims) {
     this->outDims[outDim] = size;
   }
+  computeBasisMasks();
 }
 
 LinearLayout::LinearLayout(BasesT bases, ArrayRef<StringAttr> outDimNames)
@@ -221,6 +375,7 @@ LinearLayout::LinearLayout(BasesT bases, ArrayRef<StringAttr> outDimNames)
       }
     }
   }
+  computeBasisMasks();
 
   std::optional<std::string> error =
       checkInvariants(/*requireSurjective=*/true);
@@ -239,6 +394,45 @@ LinearLayout::LinearLayout(BasesT bases,
   }
 }
 
+void LinearLayout::computeBasisMasks() {
+  basisMasks.clear();
+  for (const auto &[inDim, inDimBases] : bases) {
+    for (const auto &basis : inDimBases) {
+      // Invalid bases are rejected by checkInvariants; here we only avoid
+      // shifting out of range before that happens.
+      uint64_t mask = 0;
+      int shift = 0;
+      for (auto [b, outDimAndSize] : llvm::zip(basis, outDims)) {
+        if (shift < 64)
+          mask |= uint64_t(uint32_t(b)) << shift;
+        shift += llvm::Log2_32(outDimAndSize.second);
+      }
+      basisMasks.push_back(mask);
+    }
+  }
+}
+
+uint64_t LinearLayout::applyPacked(uint64_t ins) const {
+  assert((basisMasks.size() == 64 || ins >> basisMasks.size() == 0) &&
+         "Input out of range");
+  uint64_t outs = 0;
+  for (; ins != 0; ins &= ins - 1) {
+    outs ^= basisMasks[__builtin_ctzll(ins)];
+  }
+  return outs;
+}
+
+std::vector<int32_t> LinearLayout::unpackOuts(uint64_t outs) const {
+  std::vector<int32_t> ret;
+  ret.reserve(outDims.size());
+  for (auto [outDim, size] : outDims) {
+    int32_t sizeLog2 = llvm::Log2_32(size);
+    ret.push_back(outs & ((uint64_t(1) << sizeLog2) - 1));
+    outs >>= sizeLog2;
+  }
+  return ret;
+}
+
 std::optional<std::string>
 LinearLayout::checkInvariants(bool requireSurjective) {
   LDBG("checkInvariants: " << toString());
@@ -296,13 +490,13 @@ LinearLayout::checkInvariants(bool requireSurjective) {
   // is equivalent to checking that the number of linearly-independent bases
   // is equal to sum(getOutDimSizeLog2).  This can be computed by finding
   // the rank of the matrix whose columns are those bases.  We can compute
-  // the rank of our matrix using Gaussian elimination, which runs in O(n^3)
-  // for an n x n matrix.  Our matrix size is sum(inDimSizeLog2) x
-  // sum(outDimSizeLog2), so this should be plenty fast.
-  this->surjective =
-      getMatrixRank(getMatrix(*this), /*numRows=*/getTotalOutDimSizeLog2(),
-                    /*numCols=*/getTotalInDimSizeLog2()) ==
-      getTotalOutDimSizeLog2();
+  // the rank of our matrix using Gaussian elimination over the bit-packed
+  // bases, which takes O(n^2) word operations for an n x n matrix.  Our matrix
+  // size is sum(inDimSizeLog2) x sum(outDimSizeLog2), so this is plenty fast.
+  assert(getTotalInDimSizeLog2() <= 64 && getTotalOutDimSizeLog2() <= 64 &&
+         "LinearLayout too large");
+  this->surjective = llvm::popcount(getPivotColumns(basisMasks)) ==
+                     getTotalOutDimSizeLog2();
 
   if (requireSurjective && !surjective) {
     return "Layout is expected to be surjective, i.e. every `out` coordinate "
@@ -681,6 +875,13 @@ bool LinearLayout::isTrivialOver(ArrayRef<StringAttr> dimNames) const {
 
 std::optional<LinearLayout>
 LinearLayout::quotient(ArrayRef<StringAttr> dimNames) const {
+  return LayoutOpCache::get().getOrCompute(
+      LayoutCacheKind::Quotient, {this}, dimNames,
+      [&] { return quotientImpl(dimNames); });
+}
+
+std::optional<LinearLayout>
+LinearLayout::quotientImpl(ArrayRef<StringAttr> dimNames) const {
   if (!isTrivialOver(dimNames)) {
     return std::nullopt;
   }
@@ -757,38 +958,79 @@ SmallVector<std::pair<StringAttr, int32_t>>
 LinearLayout::apply(ArrayRef<std::pair<StringAttr, int32_t>> ins) const {
   assertDimsEqualIgnoringOrder(llvm::make_first_range(ins), getInDimNames());
 
+  // Pack the input in the order of our in-dims, dropping the bits that are
+  // out of range for each in-dim.
+  uint64_t packedIns = 0;
+  int shift = 0;
+  for (const auto &[inDim, inDimBases] : bases) {
+    int32_t val = llvm::find_if(ins, [&, &inDim = inDim](auto &in) {
+                    return in.first == inDim;
+                  })->second;
+    uint64_t sizeMask = lowBitsMask(inDimBases.size());
+    if (shift < 64)
+      packedIns |= (uint64_t(uint32_t(val)) & sizeMask) << shift;
+    shift += inDimBases.size();
+  }
+
   SmallVector<std::pair<StringAttr, int32_t>> ret;
-  for (StringAttr outDim : getOutDimNames()) {
-    int32_t outVal = 0;
-    for (auto &[inDim, val] : ins) {
-      for (int i = 0; i < getInDimSizeLog2(inDim); i++) {
-        if (val & (1 << i))
-          outVal ^= getBasis(inDim, i, outDim);
-      }
-    }
+  for (auto [outDim, outVal] :
+       llvm::zip(getOutDimNames(), unpackOuts(applyPacked(packedIns)))) {
     ret.push_back({outDim, outVal});
   }
   return ret;
 }
 
 LinearLayout LinearLayout::compose(const LinearLayout &outer) const {
+  return *LayoutOpCache::get().getOrCompute(
+      LayoutCacheKind::Compose, {this, &outer}, {},
+      [&] { return composeImpl(outer); });
+}
+
+LinearLayout LinearLayout::composeImpl(const LinearLayout &outer) const {
   assertDimsEqualIgnoringOrder(getOutDimNames(), outer.getInDimNames());
   for (StringAttr outDim : getOutDimNames()) {
     assert(getOutDimSize(outDim) <= outer.getInDimSize(outDim));
   }
 
+  // Our packed outputs are packed in the order of our out-dims, but outer's
+  // packed inputs are packed in the order of its in-dims, and an in-dim of
+  // outer may be larger than our out-dim.  Find where each of our out-dims
+  // lives in both packings, so that we can move its bits across.
+  struct DimBits {
+    int thisShift;
+    int outerShift;
+    uint64_t sizeMask;
+  };
+  SmallVector<DimBits> dimBits;
+  bool samePacking = true;
+  int thisShift = 0;
+  for (auto [outDim, size] : outDims) {
+    int outerShift = 0;
+    for (const auto &[outerInDim, outerInDimBases] : outer.bases) {
+      if (outerInDim == outDim)
+        break;
+      outerShift += outerInDimBases.size();
+    }
+    int sizeLog2 = llvm::Log2_32(size);
+    dimBits.push_back({thisShift, outerShift, (uint64_t(1) << sizeLog2) - 1});
+    samePacking &= thisShift == outerShift;
+    thisShift += sizeLog2;
+  }
+
   BasesT newBases;
+  auto basisMask = basisMasks.begin();
   for (const auto &[inDim, inDimBases] : bases) {
     auto &newInDimBases = newBases[inDim];
-    for (const auto &basis : inDimBases) {
-      SmallVector<std::pair<StringAttr, int32_t>> bases;
-      for (auto [outDim, b] : llvm::zip(getOutDimNames(), basis)) {
-        bases.push_back({outDim, b});
+    for (int i = 0; i < inDimBases.size(); i++, ++basisMask) {
+      uint64_t outerIns = *basisMask;
+      if (!samePacking) {
+        outerIns = 0;
+        for (const DimBits &d : dimBits) {
+          outerIns |= ((*basisMask >> d.thisShift) & d.sizeMask)
+                      << d.outerShift;
+        }
       }
-      auto newBases = outer.apply(bases);
-      auto newBasesRange = llvm::make_second_range(newBases);
-      newInDimBases.push_back(
-          std::vector<int32_t>(newBasesRange.begin(), newBasesRange.end()));
+      newInDimBases.push_back(outer.unpackOuts(outer.applyPacked(outerIns)));
     }
   }
 
@@ -891,6 +1133,13 @@ LinearLayout lstsq(const LinearLayout &A, const LinearLayout &B) {
 } // namespace
 
 LinearLayout LinearLayout::invertAndCompose(const LinearLayout &outer) const {
+  return *LayoutOpCache::get().getOrCompute(
+      LayoutCacheKind::InvertAndCompose, {this, &outer}, {},
+      [&] { return invertAndComposeImpl(outer); });
+}
+
+LinearLayout
+LinearLayout::invertAndComposeImpl(const LinearLayout &outer) const {
   // TODO(Lezcano) Make friend and perhaps rename to `convertFrom` or `lstsq`
   // For this, we need to implement our LLVM lowerings by inverting the "outer"
   // layout, and then iterating over the elements from the "this" layout and
@@ -988,35 +1237,16 @@ LinearLayout LinearLayout::pseudoinvert() const {
 
 llvm::MapVector<StringAttr, int32_t>
 LinearLayout::getFreeVariableMasks() const {
-  std::unique_ptr<uint64_t[]> mat = getMatrix(*this);
-  int numRows = getTotalOutDimSizeLog2();
-  int numCols = getTotalInDimSizeLog2();
-
-  // stride is specified in number of 64-bit words per row, and we pack our
-  // matrix so that there's only one uint64_t per row.
-  assert(numCols <= 64);
-  f2reduce::inplace_rref_strided(mat.get(), numRows, numCols, /*stride=*/1);
-
-  // For each row in the RREF matrix, identify the column with the first "1".
-  // These columns correspond to the basic (i.e. non-free) variables.
-  std::set<int32_t> basicVars;
-  for (int r = 0; r < numRows; r++) {
-    if (mat[r] == 0) {
-      continue;
-    }
-    basicVars.insert(__builtin_ctzll(mat[r]));
-  }
+  // The pivot columns of the RREF matrix correspond to the basic (i.e.
+  // non-free) variables; every other column is a free variable.
+  uint64_t freeVars = ~getPivotColumns(basisMasks);
 
   llvm::MapVector<StringAttr, int32_t> ret;
-  int c = 0;
-  for (StringAttr dim : getInDimNames()) {
-    int32_t mask = 0;
-    for (int i = 0; i < getInDimSizeLog2(dim); i++, c++) {
-      if (basicVars.count(c) == 0) {
-        mask |= (1 << i);
-      }
-    }
-    ret[dim] = mask;
+  unsigned shift = 0;
+  for (const auto &[inDim, inDimBases] : bases) {
+    uint64_t sizeMask = lowBitsMask(inDimBases.size());
+    ret[inDim] = shift < 64 ? (freeVars >> shift) & sizeMask : 0;
+    shift += inDimBases.size();
   }
   return ret;
 }
@@ -1,8 +1,10 @@
+#include <array>
 #include <atomic>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <stdexcept>
@@ -18,7 +20,21 @@ struct npy_half {
 
 enum class MemSemantic { ACQUIRE_RELEASE, ACQUIRE, RELEASE, RELAXED };
 
-std::mutex atomic_op_guard;
+// Atomic operations that cannot be performed with hardware atomics are
+// serialized by a mutex chosen from the address of the location, so that
+// programs updating unrelated locations don't contend on a single lock.
+// Addresses are hashed at 8-byte granularity so that overlapping accesses of
+// different sizes map to the same mutex.
+constexpr unsigned kNumAtomicOpGuardsLog2 = 8;
+constexpr size_t kNumAtomicOpGuards = 1 << kNumAtomicOpGuardsLog2;
+std::array<std::mutex, kNumAtomicOpGuards> atomic_op_guards;
+
+std::mutex &getAtomicOpGuard(const void *loc) {
+  auto addr = reinterpret_cast<uintptr_t>(loc) >> 3;
+  // Fibonacci hashing spreads strided addresses across all the mutexes
+  return atomic_op_guards[(addr * 0x9E3779B97F4A7C15ull) >>
+                          (64 - kNumAtomicOpGuardsLog2)];
+}
 
 template <typename T>
 constexpr bool is_reinterpret_cast_to_atomic_safe =
@@ -57,7 +73,7 @@ T atomic_cmp(T *ptr, T val, std::memory_order order) {
       }
     }
   } else {
-    const std::lock_guard<std::mutex> lock(atomic_op_guard);
+    const std::lock_guard<std::mutex> lock(getAtomicOpGuard(ptr));
     old_val = *ptr;
     if (cmp(old_val, val)) {
       *ptr = val;
@@ -80,7 +96,7 @@ template <typename T> T atomic_fadd(T *loc, T value, std::memory_order order) {
     } while (
         !atomic_loc->compare_exchange_weak(old_value, new_value, order, order));
   } else {
-    const std::lock_guard<std::mutex> lock(atomic_op_guard);
+    const std::lock_guard<std::mutex> lock(getAtomicOpGuard(loc));
     old_value = *loc;
     *loc = old_value + value;
   }
@@ -280,17 +296,45 @@ float npy_half_to_float(npy_half h) {
   return BitCast<float>(ToFloatBits(h.value));
 }
 
+// Atomically replaces the 16-bit value at `loc` with `op(old)` by a CAS loop on
+// the aligned 32-bit word that contains it, and returns the old value.
+template <typename Fn>
+uint16_t atomic_update_halfword(uint16_t *loc, Fn op,
+                                std::memory_order order) {
+  static_assert(is_reinterpret_cast_to_atomic_safe<uint32_t>,
+                "32-bit atomics are required for 16-bit atomic updates");
+  auto addr = reinterpret_cast<uintptr_t>(loc);
+  auto *word = reinterpret_cast<std::atomic<uint32_t> *>(
+      addr & ~static_cast<uintptr_t>(3));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  unsigned shift = (2 - (addr & 2)) * 8;
+#else
+  unsigned shift = (addr & 2) * 8;
+#endif
+  uint32_t mask = static_cast<uint32_t>(0xffffu) << shift;
+  uint32_t old_word = word->load(std::memory_order_relaxed);
+  uint32_t new_word;
+  do {
+    uint16_t old_value = static_cast<uint16_t>((old_word & mask) >> shift);
+    new_word = (old_word & ~mask) |
+               (static_cast<uint32_t>(op(old_value)) << shift);
+  } while (!word->compare_exchange_weak(old_word, new_word, order,
+                                        std::memory_order_relaxed));
+  return static_cast<uint16_t>((old_word & mask) >> shift);
+}
+
 template <>
 npy_half atomic_fadd<npy_half>(npy_half *loc, npy_half value,
                                std::memory_order order) {
-  npy_half old_value;
-
-  const std::lock_guard<std::mutex> lock(atomic_op_guard);
-  old_value = *loc;
-  *loc = npy_float_to_half(npy_half_to_float(old_value) +
-                           npy_half_to_float(value));
-
-  return old_value;
+  uint16_t old_value = atomic_update_halfword(
+      &loc->value,
+      [&](uint16_t old) {
+        return npy_float_to_half(npy_half_to_float({old}) +
+                                 npy_half_to_float(value))
+            .value;
+      },
+      order);
+  return {old_value};
 }
 
 class AtomicOp {
@@ -358,7 +402,7 @@ protected:
           reinterpret_cast<std::atomic<DType> *>(loc);
       old_val = std::atomic_fetch_add_explicit(atomic_loc, value, order);
     } else {
-      const std::lock_guard<std::mutex> lock(atomic_op_guard);
+      const std::lock_guard<std::mutex> lock(getAtomicOpGuard(loc));
       old_val = *loc;
       *loc = *loc + value;
     }
@@ -394,7 +438,7 @@ protected:
           reinterpret_cast<std::atomic<DType> *>(loc);
       old_val = std::atomic_fetch_and_explicit(atomic_loc, value, order);
     } else {
-      const std::lock_guard<std::mutex> lock(atomic_op_guard);
+      const std::lock_guard<std::mutex> lock(getAtomicOpGuard(loc));
       old_val = *loc;
       *loc = *loc & value;
     }
@@ -417,7 +461,7 @@ protected:
           reinterpret_cast<std::atomic<DType> *>(loc);
       old_val = std::atomic_fetch_or_explicit(atomic_loc, value, order);
     } else {
-      const std::lock_guard<std::mutex> lock(atomic_op_guard);
+      const std::lock_guard<std::mutex> lock(getAtomicOpGuard(loc));
       old_val = *loc;
       *loc = *loc | value;
     }
@@ -440,7 +484,7 @@ protected:
           reinterpret_cast<std::atomic<DType> *>(loc);
       old_val = std::atomic_fetch_xor_explicit(atomic_loc, value, order);
     } else {
-      const std::lock_guard<std::mutex> lock(atomic_op_guard);
+      const std::lock_guard<std::mutex> lock(getAtomicOpGuard(loc));
       old_val = *loc;
       *loc = *loc ^ value;
     }
@@ -491,7 +535,7 @@ protected:
           reinterpret_cast<std::atomic<DType> *>(loc);
       old_val = atomic_loc->exchange(value, order);
     } else {
-      const std::lock_guard<std::mutex> lock(atomic_op_guard);
+      const std::lock_guard<std::mutex> lock(getAtomicOpGuard(loc));
       old_val = *loc;
       *loc = value;
     }
@@ -511,7 +555,7 @@ void atomic_compare_exchange_strong(void *loc, void *expected,
     atomic_loc->compare_exchange_strong(*expected_uint, desired_val, order,
                                         order);
   } else {
-    const std::lock_guard<std::mutex> lock(atomic_op_guard);
+    const std::lock_guard<std::mutex> lock(getAtomicOpGuard(loc));
     T *atomic_loc = static_cast<T *>(loc);
     if (*atomic_loc == *expected_uint) {
       *atomic_loc = desired_val;
@@ -607,6 +651,191 @@ makeAtomicRMWOp(pybind11::dtype dtype, const uint64_t *ptr, const void *val,
   return atomic_op;
 }
 
+// A one-dimensional, row-major view over the elements of a numpy array.
+// Arrays coming from the interpreter are frequently broadcast views, so the
+// view is expressed as a base pointer and a byte stride.
+struct FlatView {
+  py::array array; // Keeps the viewed buffer alive
+  const char *data;
+  ptrdiff_t stride;
+
+  const char *at(ptrdiff_t i) const { return data + i * stride; }
+};
+
+FlatView flatten(const py::array &array, ptrdiff_t numel) {
+  auto *data = static_cast<const char *>(array.data());
+  if (array.flags() & py::array::c_style)
+    return {array, data, array.itemsize()};
+  bool broadcast = true;
+  for (py::ssize_t d = 0; d < array.ndim(); ++d)
+    broadcast &= array.strides(d) == 0 || array.shape(d) == 1;
+  if (broadcast)
+    return {array, data, 0};
+  py::array reshaped = array.reshape({numel});
+  return {reshaped, static_cast<const char *>(reshaped.data()),
+          numel > 0 ? reshaped.strides(0) : 0};
+}
+
+uint64_t loadAddress(const FlatView &ptr, ptrdiff_t i) {
+  uint64_t addr;
+  memcpy(&addr, ptr.at(i), sizeof(addr));
+  return addr;
+}
+
+// Returns the byte distance between consecutive pointers if all pointers are
+// equally spaced.
+std::optional<int64_t> getConstantStride(const FlatView &ptr,
+                                         ptrdiff_t numel) {
+  if (numel <= 1)
+    return 0;
+  int64_t stride = loadAddress(ptr, 1) - loadAddress(ptr, 0);
+  uint64_t expected = loadAddress(ptr, 0);
+  for (ptrdiff_t i = 0; i < numel; ++i, expected += stride) {
+    if (loadAddress(ptr, i) != expected)
+      return std::nullopt;
+  }
+  return stride;
+}
+
+bool isAllTrue(const FlatView &mask, ptrdiff_t numel) {
+  for (ptrdiff_t i = 0; i < numel; ++i) {
+    if (!*mask.at(i))
+      return false;
+  }
+  return true;
+}
+
+// Element-wise copies are specialized on the element size so that the inner
+// loops work on typed values instead of calling memcpy per element.
+template <typename T>
+void gatherStrided(char *dst, const char *src, int64_t src_stride,
+                   ptrdiff_t numel) {
+  T *out = reinterpret_cast<T *>(dst);
+  for (ptrdiff_t i = 0; i < numel; ++i) {
+    T v;
+    memcpy(&v, src + i * src_stride, sizeof(T));
+    out[i] = v;
+  }
+}
+
+template <typename T>
+void gatherMasked(char *dst, const FlatView &ptr, const FlatView &mask,
+                  const FlatView &other, ptrdiff_t numel) {
+  T *out = reinterpret_cast<T *>(dst);
+  for (ptrdiff_t i = 0; i < numel; ++i) {
+    T v;
+    if (*mask.at(i))
+      memcpy(&v, reinterpret_cast<const void *>(loadAddress(ptr, i)),
+             sizeof(T));
+    else
+      memcpy(&v, other.at(i), sizeof(T));
+    out[i] = v;
+  }
+}
+
+template <typename T>
+void scatterStrided(char *dst, int64_t dst_stride, const FlatView &value,
+                    ptrdiff_t numel) {
+  for (ptrdiff_t i = 0; i < numel; ++i) {
+    T v;
+    memcpy(&v, value.at(i), sizeof(T));
+    memcpy(dst + i * dst_stride, &v, sizeof(T));
+  }
+}
+
+template <typename T>
+void scatterMasked(const FlatView &ptr, const FlatView &value,
+                   const FlatView &mask, ptrdiff_t numel) {
+  for (ptrdiff_t i = 0; i < numel; ++i) {
+    if (*mask.at(i)) {
+      T v;
+      memcpy(&v, value.at(i), sizeof(T));
+      memcpy(reinterpret_cast<void *>(loadAddress(ptr, i)), &v, sizeof(T));
+    }
+  }
+}
+
+// Invokes `fn` with a `T` of the given size, or `false` if unsupported.
+template <typename Fn> bool dispatchItemsize(size_t itemsize, Fn &&fn) {
+  switch (itemsize) {
+  case 1:
+    fn(uint8_t{});
+    return true;
+  case 2:
+    fn(uint16_t{});
+    return true;
+  case 4:
+    fn(uint32_t{});
+    return true;
+  case 8:
+    fn(uint64_t{});
+    return true;
+  default:
+    return false;
+  }
+}
+
+void load(const FlatView &ptr, const FlatView &mask, const FlatView &other,
+          char *ret, size_t itemsize, ptrdiff_t numel) {
+  if (numel == 0)
+    return;
+  if (isAllTrue(mask, numel)) {
+    if (auto stride = getConstantStride(ptr, numel)) {
+      auto *src = reinterpret_cast<const char *>(loadAddress(ptr, 0));
+      if (*stride == static_cast<int64_t>(itemsize)) {
+        memcpy(ret, src, itemsize * numel);
+        return;
+      }
+      if (dispatchItemsize(itemsize, [&](auto t) {
+            gatherStrided<decltype(t)>(ret, src, *stride, numel);
+          }))
+        return;
+    }
+  }
+  if (dispatchItemsize(itemsize, [&](auto t) {
+        gatherMasked<decltype(t)>(ret, ptr, mask, other, numel);
+      }))
+    return;
+  for (ptrdiff_t i = 0; i < numel; ++i) {
+    if (*mask.at(i))
+      memcpy(ret + i * itemsize,
+             reinterpret_cast<const void *>(loadAddress(ptr, i)), itemsize);
+    else
+      memcpy(ret + i * itemsize, other.at(i), itemsize);
+  }
+}
+
+void store(const FlatView &ptr, const FlatView &value, const FlatView &mask,
+           size_t itemsize, ptrdiff_t numel) {
+  if (numel == 0)
+    return;
+  if (isAllTrue(mask, numel)) {
+    if (auto stride = getConstantStride(ptr, numel)) {
+      auto *dst = reinterpret_cast<char *>(loadAddress(ptr, 0));
+      if (*stride == static_cast<int64_t>(itemsize) &&
+          value.stride == static_cast<ptrdiff_t>(itemsize)) {
+        memcpy(dst, value.data, itemsize * numel);
+        return;
+      }
+      // A zero stride means every element is stored to the same address; the
+      // last one wins, as in the element-wise loop below.
+      if (*stride != 0 && dispatchItemsize(itemsize, [&](auto t) {
+            scatterStrided<decltype(t)>(dst, *stride, value, numel);
+          }))
+        return;
+    }
+  }
+  if (dispatchItemsize(itemsize, [&](auto t) {
+        scatterMasked<decltype(t)>(ptr, value, mask, numel);
+      }))
+    return;
+  for (ptrdiff_t i = 0; i < numel; ++i) {
+    if (*mask.at(i))
+      memcpy(reinterpret_cast<void *>(loadAddress(ptr, i)), value.at(i),
+             itemsize);
+  }
+}
+
 } // namespace
 
 void init_triton_interpreter(py::module &&m) {
@@ -635,37 +864,32 @@ void init_triton_interpreter(py::module &&m) {
   m.def("load",
         [](py::array_t<uint64_t> ptr, py::array_t<bool> mask, py::array other,
            py::dtype ret_dtype) -> py::array {
-          int numel = ptr.size();
+          ptrdiff_t numel = ptr.size();
           auto shape =
               std::vector<ptrdiff_t>(ptr.shape(), ptr.shape() + ptr.ndim());
-          py::array ret(ret_dtype, py::array::ShapeContainer{numel});
-          py::array_t<uint64_t> reshaped_ptr = ptr.reshape({numel});
-          py::array_t<bool> reshaped_mask = mask.reshape({numel});
-          py::array reshaped_others = other.reshape({numel});
-          for (size_t i = 0; i < ptr.size(); ++i) {
-            if (reshaped_mask.at(i))
-              memcpy(ret.mutable_data(i),
-                     reinterpret_cast<void *>(reshaped_ptr.at(i)),
-                     ret_dtype.itemsize());
-            else
-              memcpy(ret.mutable_data(i), reshaped_others.data(i),
-                     ret_dtype.itemsize());
+          py::array ret(ret_dtype, shape);
+          FlatView ptr_view = flatten(ptr, numel);
+          FlatView mask_view = flatten(mask, numel);
+          FlatView other_view = flatten(other, numel);
+          auto *ret_data = static_cast<char *>(ret.mutable_data());
+          auto itemsize = ret_dtype.itemsize();
+          {
+            // Programs of the same grid may run concurrently on other threads
+            py::gil_scoped_release release;
+            load(ptr_view, mask_view, other_view, ret_data, itemsize, numel);
           }
-          return ret.reshape(shape);
+          return ret;
         });
 
   m.def("store",
         [](py::array_t<uint64_t> ptr, py::array value, py::array_t<bool> mask) {
-          int numel = ptr.size();
-          py::array_t<uint64_t> reshaped_ptr = ptr.reshape({numel});
-          py::array_t<int8_t> reshaped_mask = mask.reshape({numel});
-          py::array reshaped_value = value.reshape({numel});
-          for (size_t i = 0; i < ptr.size(); ++i) {
-            if (reshaped_mask.at(i)) {
-              memcpy(reinterpret_cast<void *>(reshaped_ptr.mutable_at(i)),
-                     reshaped_value.data(i), value.dtype().itemsize());
-            }
-          }
+          ptrdiff_t numel = ptr.size();
+          FlatView ptr_view = flatten(ptr, numel);
+          FlatView value_view = flatten(value, numel);
+          FlatView mask_view = flatten(mask, numel);
+          auto itemsize = value.dtype().itemsize();
+          py::gil_scoped_release release;
+          store(ptr_view, value_view, mask_view, itemsize, numel);
         });
 
   m.def("atomic_rmw",
@@ -711,7 +935,10 @@ void init_triton_interpreter(py::module &&m) {
 
 #undef MAKE_ATOMIC_RMW_OP
 
-          atomic_op->apply();
+          {
+            py::gil_scoped_release release;
+            atomic_op->apply();
+          }
           return ret.reshape(shape);
         });
 
@@ -731,10 +958,13 @@ void init_triton_interpreter(py::module &&m) {
           memcpy(static_cast<void *>(ret.mutable_data()),
                  static_cast<const void *>(reshaped_cmp.data()),
                  itemsize * numel);
-          AtomicCASOp(reshaped_ptr.data(), ret.mutable_data(),
-                      static_cast<const void *>(reshaped_val.data()), itemsize,
-                      numel, order)
-              .apply();
+          AtomicCASOp cas_op(reshaped_ptr.data(), ret.mutable_data(),
+                             static_cast<const void *>(reshaped_val.data()),
+                             itemsize, numel, order);
+          {
+            py::gil_scoped_release release;
+            cas_op.apply();
+          }
           return ret.reshape(shape);
         });
 }
@@ -28,6 +28,7 @@
 #include "triton/Dialect/Triton/IR/Types.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Tools/LinearLayout.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/SourceMgr.h"
@@ -1644,8 +1645,9 @@ void init_triton_ir(py::module &&m) {
            })
       .def("create_scan",
            [](TritonOpBuilder &self, std::vector<Value> operands, int axis,
-              bool reverse) -> OpState {
-             return self.create<ScanOp>(operands, axis, reverse);
+              bool reverse, bool segmented, bool exclusive) -> OpState {
+             return self.create<ScanOp>(operands, axis, reverse, segmented,
+                                        exclusive);
            })
       .def("create_scan_ret",
            [](TritonOpBuilder &self, py::args args) -> OpState {
@@ -1711,6 +1713,27 @@ void init_triton_ir(py::module &&m) {
       .def("create_gather",
            [](TritonOpBuilder &self, Value src, Value indices, int axis)
                -> Value { return self.create<GatherOp>(src, indices, axis); })
+      .def("create_sort",
+           [](TritonOpBuilder &self, Value src, int axis, bool descending,
+              bool isUnsigned) -> Value {
+             return self.create<SortOp>(src.getType(), src, axis, descending,
+                                        isUnsigned);
+           })
+      .def("create_topk",
+           [](TritonOpBuilder &self, Value src, int k, int axis,
+              bool isUnsigned, bool returnIndices) -> std::vector<Value> {
+             auto srcType = cast<RankedTensorType>(src.getType());
+             SmallVector<int64_t> shape(srcType.getShape());
+             shape[axis] = k;
+             Type indicesType;
+             if (returnIndices)
+               indicesType = RankedTensorType::get(
+                   shape, IntegerType::get(src.getContext(), 32));
+             auto op = self.create<TopKOp>(
+                 RankedTensorType::get(shape, srcType.getElementType()),
+                 indicesType, src, k, axis, isUnsigned);
+             return std::vector<Value>(op->result_begin(), op->result_end());
+           })
       // Force GPU barrier
       .def("create_barrier",
            [](TritonOpBuilder &self) { self.create<mlir::gpu::BarrierOp>(); })
@@ -1865,8 +1888,17 @@ void init_triton_ir(py::module &&m) {
         if (showStacktraces) {
           context->disableMultithreading();
         }
-        if (failed(self.run(mod.getOperation())))
+        // The passes do not touch Python objects, so let other threads
+        // (e.g. concurrent compilations) run meanwhile.
+        LogicalResult result = failure();
+        {
+          py::gil_scoped_release allow_threads;
+          result = self.run(mod.getOperation());
+        }
+        if (failed(result))
           throw std::runtime_error("PassManager::run failed");
+        if (haveTiming)
+          printLayoutCacheStatistics(llvm::errs());
       });
 }
 
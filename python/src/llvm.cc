@@ -393,6 +393,7 @@ void init_triton_llvm(py::module &&m) {
           mpm.addPass(AddressSanitizerPass(Opts));
         }
         mpm.addPass(pb.buildPerModuleDefaultPipeline(opt));
+        py::gil_scoped_release allow_threads;
         mpm.run(*mod, mam);
       },
       // Mandatory parameters
@@ -5,8 +5,10 @@
 #include "passes.h"
 #include "triton/Analysis/Allocation.h"
 #include "triton/Analysis/Membar.h"
+#include "triton/Analysis/Utility.h"
 #include "triton/Conversion/TritonGPUToLLVM/Passes.h"
 #include "triton/Conversion/TritonToTritonGPU/Passes.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Target/LLVMIR/Passes.h"
@@ -17,10 +19,20 @@ namespace py = pybind11;
 
 void init_triton_analysis(py::module &&m) {
   py::class_<mlir::ModuleAllocation>(m, "allocation", py::module_local())
-      .def(py::init<mlir::ModuleOp>());
+      .def(py::init<mlir::ModuleOp>())
+      .def("get_shared_memory_size", [](mlir::ModuleAllocation &self) {
+        return self.getSharedMemorySize();
+      });
   py::class_<mlir::ModuleMembarAnalysis>(m, "membar", py::module_local())
       .def(py::init<mlir::ModuleAllocation *>())
       .def("run", &mlir::ModuleMembarAnalysis::run);
+  m.def("estimate_register_pressure", [](mlir::ModuleOp mod) {
+    unsigned registers = 0;
+    mod.walk([&](mlir::triton::FuncOp funcOp) {
+      registers = std::max(registers, mlir::estimateRegisterPressure(funcOp));
+    });
+    return registers;
+  });
 }
 
 void init_triton_passes_common(py::module &&m) {
@@ -49,20 +61,20 @@ void init_triton_passes_ttir(py::module &&m) {
 void init_triton_passes_ttgpuir(py::module &&m) {
   using namespace mlir::triton::gpu;
   ADD_PASS_WRAPPER_0("add_coalesce", createTritonGPUCoalesce);
-  ADD_PASS_WRAPPER_0("add_optimize_thread_locality",
-                     createTritonGPUOptimizeThreadLocality);
+  ADD_FUNC_PASS_WRAPPER_0("add_optimize_thread_locality",
+                          createTritonGPUOptimizeThreadLocality);
   ADD_PASS_OPTION_WRAPPER_1("add_pipeline", createTritonGPUPipeline, int);
   ADD_PASS_WRAPPER_0("add_prefetch", createTritonGPUPrefetch);
   ADD_PASS_WRAPPER_0("add_accelerate_matmul", createTritonGPUAccelerateMatmul);
-  ADD_PASS_WRAPPER_0("add_reorder_instructions",
-                     createTritonGPUReorderInstructions);
+  ADD_FUNC_PASS_WRAPPER_0("add_reorder_instructions",
+                          createTritonGPUReorderInstructions);
   ADD_PASS_WRAPPER_0("add_f32_dot_tc", createTritonGPUF32DotTC);
   ADD_PASS_OPTION_WRAPPER_1("add_optimize_dot_operands",
                             createTritonGPUOptimizeDotOperands, bool);
-  ADD_PASS_WRAPPER_0("add_remove_layout_conversions",
-                     createTritonGPURemoveLayoutConversions);
-  ADD_PASS_WRAPPER_0("add_reduce_data_duplication",
-                     createTritonGPUReduceDataDuplication);
+  ADD_FUNC_PASS_WRAPPER_0("add_remove_layout_conversions",
+                          createTritonGPURemoveLayoutConversions);
+  ADD_FUNC_PASS_WRAPPER_0("add_reduce_data_duplication",
+                          createTritonGPUReduceDataDuplication);
   ADD_PASS_WRAPPER_0("add_allocate_shared_memory",
                      createAllocateSharedMemoryPass);
   ADD_PASS_WRAPPER_0("add_allocate_global_scratch_memory",
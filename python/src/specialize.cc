@@ -0,0 +1,301 @@
+#include <Python.h>
+#include <cstdint>
+#include <cstring>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+
+// Flags of a kernel parameter, mirroring the arguments of specialize_impl in
+// runtime/jit.py.
+enum ParamFlags : uint8_t {
+  kConstexpr = 1,
+  kNoSpecialize = 2,
+  kNoAlign = 4,
+};
+
+// Tags that separate the kinds of arguments in the key.
+enum Tag : uint64_t {
+  kNone = 1,
+  kBool,
+  kOne,
+  kI32,
+  kU64,
+  kI64,
+  kFloat,
+  kTensor,
+  kTuple,
+  kString,
+  kValue,
+  kKwarg,
+};
+
+inline void combine(uint64_t &h, uint64_t value) {
+  h = (h ^ value) * 0x9E3779B97F4A7C15ull;
+  h ^= h >> 32;
+}
+
+// Objects whose address is part of a key (tensor types and dtypes) are kept
+// alive, so that the address is never reused by another object.
+void pin(PyObject *obj) {
+  static std::unordered_set<PyObject *> pinned;
+  if (pinned.insert(obj).second)
+    Py_INCREF(obj);
+}
+
+PyObject *internedString(const char *str) {
+  PyObject *obj = PyUnicode_InternFromString(str);
+  pin(obj);
+  return obj;
+}
+
+// Returns whether instances of `type` are specialized as tensors: they have a
+// `data_ptr` method and are not TMA descriptors.
+bool isTensorType(PyTypeObject *type) {
+  static std::unordered_map<PyTypeObject *, bool> tensorTypes;
+  auto it = tensorTypes.find(type);
+  if (it != tensorTypes.end())
+    return it->second;
+  static PyObject *dataPtr = internedString("data_ptr");
+  static PyObject *tmaDescCpuPtr = internedString("tma_desc_cpu_ptr");
+  PyObject *typeObj = reinterpret_cast<PyObject *>(type);
+  bool isTensor = PyObject_HasAttr(typeObj, dataPtr) &&
+                  !PyObject_HasAttr(typeObj, tmaDescCpuPtr);
+  pin(typeObj);
+  tensorTypes[type] = isTensor;
+  return isTensor;
+}
+
+// Hashes a value whose equality, rather than its type, matters: constexpr
+// arguments and options.  Only immutable values of builtin types are hashed,
+// since the Python implementation keys on their string representation; returns
+// false for the others.
+bool hashValue(PyObject *value, uint64_t &h) {
+  if (value == Py_None || PyBool_Check(value)) {
+    combine(h, reinterpret_cast<uintptr_t>(value));
+    return true;
+  }
+  if (PyLong_CheckExact(value)) {
+    // Python hashes -1 and -2 to the same value.
+    int overflow = 0;
+    long long v = PyLong_AsLongLongAndOverflow(value, &overflow);
+    if (overflow != 0 || (v == -1 && PyErr_Occurred())) {
+      PyErr_Clear();
+      return false;
+    }
+    combine(h, kI64);
+    combine(h, static_cast<uint64_t>(v));
+    return true;
+  }
+  if (PyFloat_CheckExact(value)) {
+    double v = PyFloat_AS_DOUBLE(value);
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    combine(h, kFloat);
+    combine(h, bits);
+    return true;
+  }
+  if (PyUnicode_CheckExact(value)) {
+    Py_hash_t hash = PyObject_Hash(value);
+    if (hash == -1) {
+      PyErr_Clear();
+      return false;
+    }
+    combine(h, kString);
+    combine(h, static_cast<uint64_t>(hash));
+    return true;
+  }
+  if (PyTuple_CheckExact(value)) {
+    Py_ssize_t size = PyTuple_GET_SIZE(value);
+    combine(h, kTuple);
+    combine(h, size);
+    for (Py_ssize_t i = 0; i < size; ++i) {
+      if (!hashValue(PyTuple_GET_ITEM(value, i), h))
+        return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+// Hashes what specialize_impl derives from a non-constexpr argument: its type,
+// whether it is 1, and whether it is divisible by 16.  Returns false for the
+// arguments that only the Python implementation handles.
+bool hashArg(PyObject *arg, uint8_t flags, uint64_t &h) {
+  bool specialize = !(flags & kNoSpecialize);
+  bool align = specialize && !(flags & kNoAlign);
+  if (arg == Py_None) {
+    combine(h, kNone);
+    return true;
+  }
+  if (PyBool_Check(arg)) {
+    combine(h, kBool);
+    return true;
+  }
+  if (PyLong_Check(arg)) {
+    int overflow = 0;
+    long long v = PyLong_AsLongLongAndOverflow(arg, &overflow);
+    if (overflow < 0 || (v == -1 && PyErr_Occurred())) {
+      PyErr_Clear();
+      return false;
+    }
+    if (overflow > 0) {
+      unsigned long long u = PyLong_AsUnsignedLongLong(arg);
+      if (u == static_cast<unsigned long long>(-1) && PyErr_Occurred()) {
+        PyErr_Clear();
+        return false;
+      }
+      combine(h, kU64);
+      combine(h, align && u % 16 == 0);
+      return true;
+    }
+    if (specialize && v == 1) {
+      combine(h, kOne);
+      return true;
+    }
+    combine(h, v >= INT32_MIN && v <= INT32_MAX ? kI32 : kI64);
+    combine(h, align && v % 16 == 0);
+    return true;
+  }
+  if (PyFloat_Check(arg)) {
+    combine(h, kFloat);
+    return true;
+  }
+  if (PyTuple_CheckExact(arg)) {
+    Py_ssize_t size = PyTuple_GET_SIZE(arg);
+    combine(h, kTuple);
+    combine(h, size);
+    // Tuple elements are always specialized.
+    for (Py_ssize_t i = 0; i < size; ++i) {
+      if (!hashArg(PyTuple_GET_ITEM(arg, i), 0, h))
+        return false;
+    }
+    return true;
+  }
+  if (!isTensorType(Py_TYPE(arg)))
+    return false;
+  static PyObject *dtypeName = internedString("dtype");
+  PyObject *dtype = PyObject_GetAttr(arg, dtypeName);
+  if (!dtype) {
+    PyErr_Clear();
+    return false;
+  }
+  pin(dtype);
+  Py_DECREF(dtype);
+  combine(h, kTensor);
+  combine(h, reinterpret_cast<uintptr_t>(dtype));
+  if (align) {
+    static PyObject *dataPtrName = internedString("data_ptr");
+    PyObject *ptr = PyObject_CallMethodObjArgs(arg, dataPtrName, nullptr);
+    if (!ptr) {
+      PyErr_Clear();
+      return false;
+    }
+    unsigned long long address = PyLong_AsUnsignedLongLongMask(ptr);
+    Py_DECREF(ptr);
+    if (address == static_cast<unsigned long long>(-1) && PyErr_Occurred()) {
+      PyErr_Clear();
+      return false;
+    }
+    combine(h, address % 16 == 0);
+  }
+  return true;
+}
+
+// Computes the specialization key of a call of a JIT function from its
+// arguments, as a 64-bit integer.  Calls with the same key have the same
+// specialization and options, so that they run the same compiled kernel.
+class KeyHasher {
+public:
+  KeyHasher(const std::vector<std::string> &names,
+            const std::vector<uint8_t> &flags)
+      : flags(flags) {
+    for (const std::string &name : names)
+      this->names.push_back(internedString(name.c_str()));
+  }
+
+  // Returns None for the calls that the Python binder must handle.
+  py::object operator()(py::handle argsObj, py::handle kwargsObj) const {
+    PyObject *args = argsObj.ptr();
+    PyObject *kwargs = kwargsObj.ptr();
+    Py_ssize_t numArgs = PyTuple_GET_SIZE(args);
+    if (numArgs > static_cast<Py_ssize_t>(names.size()))
+      return py::none();
+    uint64_t h = 0;
+    combine(h, numArgs);
+    for (Py_ssize_t i = 0; i < numArgs; ++i) {
+      if (!hashParam(PyTuple_GET_ITEM(args, i), i, h))
+        return py::none();
+    }
+    PyObject *name;
+    PyObject *value;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(kwargs, &pos, &name, &value)) {
+      combine(h, kKwarg);
+      Py_hash_t nameHash = PyObject_Hash(name);
+      if (nameHash == -1) {
+        PyErr_Clear();
+        return py::none();
+      }
+      combine(h, static_cast<uint64_t>(nameHash));
+      int param = findParam(name);
+      if (param < 0) {
+        return py::none();
+      }
+      bool hashed = param < static_cast<int>(names.size())
+                        ? hashParam(value, param, h)
+                        : hashValue(value, h);
+      if (!hashed)
+        return py::none();
+    }
+    return py::int_(h);
+  }
+
+private:
+  bool hashParam(PyObject *arg, size_t param, uint64_t &h) const {
+    if (flags[param] & kConstexpr) {
+      combine(h, kValue);
+      return hashValue(arg, h);
+    }
+    return hashArg(arg, flags[param], h);
+  }
+
+  // Returns the index of the parameter called `name`, names.size() if it is
+  // not a parameter (i.e. it is an option), or -1 on error.
+  int findParam(PyObject *name) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (names[i] == name)
+        return i;
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+      int eq = PyObject_RichCompareBool(names[i], name, Py_EQ);
+      if (eq < 0) {
+        PyErr_Clear();
+        return -1;
+      }
+      if (eq)
+        return i;
+    }
+    return names.size();
+  }
+
+  std::vector<PyObject *> names;
+  std::vector<uint8_t> flags;
+};
+
+} // namespace
+
+void init_triton_specialize(py::module &&m) {
+  m.attr("CONSTEXPR") = static_cast<int>(kConstexpr);
+  m.attr("NO_SPECIALIZE") = static_cast<int>(kNoSpecialize);
+  m.attr("NO_ALIGN") = static_cast<int>(kNoAlign);
+  py::class_<KeyHasher>(m, "key_hasher", py::module_local())
+      .def(py::init<const std::vector<std::string> &,
+                    const std::vector<uint8_t> &>())
+      .def("__call__", &KeyHasher::operator());
+}
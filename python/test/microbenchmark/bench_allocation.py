@@ -0,0 +1,87 @@
+"""
+Measures the compile time of shared memory allocation on modules with many
+shared memory buffers, such as heavily pipelined kernels with multi-buffered
+`local_alloc`s.
+
+Each generated function allocates a sequence of buffers of varying sizes. A
+buffer is deallocated once a given number of later buffers have been allocated,
+so that number of buffers is live at any point, as with a multi-buffered
+software pipeline.
+
+Pass --search-steps to also run the opt-in allocation search
+(TRITON_SMEM_SEARCH_STEPS) and compare its size with the greedy one.
+
+Usage: python bench_allocation.py [--buffers 256 1024 4096] [--live 4 16] [--search-steps 10000]
+"""
+
+import argparse
+import os
+import tempfile
+import time
+
+from triton._C.libtriton import ir, passes
+
+SIZES = ["32x64", "64x64", "128x64", "16x128"]
+
+
+def make_module(num_buffers, num_live):
+    lines = [
+        "#shared = #ttg.swizzled_shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>",
+        "#smem = #ttg.shared_memory",
+        'module attributes {"ttg.num-warps" = 4 : i32, "ttg.num-ctas" = 1 : i32, "ttg.threads-per-warp" = 32 : i32} {',
+        "  tt.func public @kernel() {",
+    ]
+    types = [f"!ttg.memdesc<{SIZES[i % len(SIZES)]}xf16, #shared, #smem, mutable>" for i in range(num_buffers)]
+    for i in range(num_buffers + num_live):
+        if i < num_buffers:
+            lines.append(f"    %buf{i} = ttg.local_alloc : () -> {types[i]}")
+        j = i - num_live
+        if j >= 0:
+            lines.append(f"    ttg.local_dealloc %buf{j} : {types[j]}")
+    lines += ["    tt.return", "  }", "}"]
+    return "\n".join(lines)
+
+
+def run_allocation(src):
+    context = ir.context()
+    ir.load_dialects(context)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, "kernel.ttgir")
+        with open(path, "w") as f:
+            f.write(src)
+        mod = ir.parse_mlir_module(path, context)
+    mod.context = context
+    pm = ir.pass_manager(mod.context)
+    passes.ttgpuir.add_allocate_shared_memory(pm)
+    start = time.perf_counter()
+    pm.run(mod)
+    elapsed = time.perf_counter() - start
+    return elapsed, mod.get_int_attr("ttg.shared")
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--buffers", type=int, nargs="+", default=[256, 1024, 2048, 4096])
+    parser.add_argument("--live", type=int, nargs="+", default=[4, 16])
+    parser.add_argument("--search-steps", type=int, default=0)
+    args = parser.parse_args()
+
+    header = f"{'buffers':>10}{'live':>8}{'time (ms)':>14}{'shared (B)':>14}"
+    if args.search_steps:
+        header += f"{'search (ms)':>14}{'searched (B)':>14}"
+    print(header)
+    for num_buffers in args.buffers:
+        for num_live in args.live:
+            src = make_module(num_buffers, num_live)
+            os.environ.pop("TRITON_SMEM_SEARCH_STEPS", None)
+            elapsed, shared = run_allocation(src)
+            row = f"{num_buffers:>10}{num_live:>8}{elapsed * 1e3:>14.1f}{shared:>14}"
+            if args.search_steps:
+                os.environ["TRITON_SMEM_SEARCH_STEPS"] = str(args.search_steps)
+                elapsed, shared = run_allocation(src)
+                row += f"{elapsed * 1e3:>14.1f}{shared:>14}"
+            print(row)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,71 @@
+"""
+Measures how the interpreter's atomic primitives scale with the number of
+threads issuing them concurrently.
+
+Each thread repeatedly applies `atomic_rmw` to a block of addresses drawn from
+a small set of bins (histogram-like, high contention) or from a large buffer
+(split-K-like, low contention). The primitives release the GIL, so the
+measured throughput reflects contention between the threads inside libtriton.
+
+Usage: python bench_interpreter_atomics.py [--threads 1 2 4 8] [--iters 2000]
+"""
+
+import argparse
+import threading
+import time
+
+import numpy as np
+
+from triton._C.libtriton import interpreter as _interpreter
+
+RMW_CASES = {
+    "fadd_fp16": (_interpreter.RMW_OP.FADD, np.float16),
+    "fadd_fp32": (_interpreter.RMW_OP.FADD, np.float32),
+    "add_i64": (_interpreter.RMW_OP.ADD, np.int64),
+    "max_i32": (_interpreter.RMW_OP.MAX, np.int32),
+}
+
+
+def run_rmw(op, dtype, num_bins, num_threads, iters, block):
+    buffer = np.zeros(num_bins, dtype=dtype)
+    base = buffer.ctypes.data
+    itemsize = buffer.itemsize
+    rng = np.random.default_rng(0)
+    offsets = [rng.integers(0, num_bins, size=block) for _ in range(num_threads)]
+    ptrs = [(base + off * itemsize).astype(np.uint64) for off in offsets]
+    vals = np.ones(block, dtype=dtype)
+    mask = np.ones(block, dtype=bool)
+    barrier = threading.Barrier(num_threads + 1)
+
+    def worker(ptr):
+        barrier.wait()
+        for _ in range(iters):
+            _interpreter.atomic_rmw(op, ptr, vals, mask, _interpreter.MEM_SEMANTIC.RELAXED)
+
+    threads = [threading.Thread(target=worker, args=(ptrs[i], )) for i in range(num_threads)]
+    for t in threads:
+        t.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for t in threads:
+        t.join()
+    elapsed = time.perf_counter() - start
+    return num_threads * iters * block / elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8, 16])
+    parser.add_argument("--iters", type=int, default=2000)
+    parser.add_argument("--block", type=int, default=256)
+    args = parser.parse_args()
+
+    print(f"{'case':<12}{'bins':>10}" + "".join(f"{f'{n} thr (Mop/s)':>18}" for n in args.threads))
+    for name, (op, dtype) in RMW_CASES.items():
+        for num_bins in [16, 1 << 20]:
+            rates = [run_rmw(op, dtype, num_bins, n, args.iters, args.block) for n in args.threads]
+            print(f"{name:<12}{num_bins:>10}" + "".join(f"{rate / 1e6:>18.2f}" for rate in rates))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+"""
+Measures the host overhead of calling a JIT function whose kernel is already
+compiled, from `kernel[grid](...)` to the launcher call, with and without the
+native specialization key (`fast_caches` in `JITFunction.run`).
+
+The benchmark runs against a fake driver and a fake compiled kernel whose
+launcher does nothing, so it needs neither a GPU nor a driver, and the time
+excludes the launcher itself (see bench_launch.py).
+
+Usage: python bench_jit_launch.py [--calls 200000]
+"""
+
+import argparse
+import time
+
+import triton
+import triton.language as tl
+from triton.backends.compiler import GPUTarget
+from triton.runtime.driver import driver
+
+
+class FakeDriver:
+
+    def get_current_device(self):
+        return 0
+
+    def get_current_stream(self, device):
+        return 0
+
+    def get_current_target(self):
+        return GPUTarget("cuda", 80, 32)
+
+
+class FakeTensor:
+
+    def __init__(self, address, dtype="float32"):
+        self.address = address
+        self.dtype = dtype
+
+    def data_ptr(self):
+        return self.address
+
+
+class FakeKernel:
+    function = 0
+    packed_metadata = ()
+
+    def run(self, *args):
+        pass
+
+    def launch_metadata(self, grid, stream, *args):
+        return None
+
+
+@triton.jit
+def add_kernel(x_ptr, y_ptr, out_ptr, n, BLOCK: tl.constexpr):
+    offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    mask = offsets < n
+    tl.store(out_ptr + offsets, tl.load(x_ptr + offsets, mask=mask) + tl.load(y_ptr + offsets, mask=mask), mask=mask)
+
+
+def bench(args, kwargs, num_calls):
+    grid = (64, )
+    for _ in range(10):
+        add_kernel[grid](*args, **kwargs)
+    start = time.perf_counter()
+    for _ in range(num_calls):
+        add_kernel[grid](*args, **kwargs)
+    return (time.perf_counter() - start) / num_calls
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--calls", type=int, default=200000)
+    args = parser.parse_args()
+
+    driver.set_active(FakeDriver())
+    # Creates the binder of the device, which sets `compile`.
+    add_kernel.device_caches[0]
+    add_kernel.compile = lambda src, target, options: FakeKernel()
+    key_hasher = add_kernel.key_hasher
+
+    x, y, out = (FakeTensor(1 << 20) for _ in range(3))
+    calls = [
+        ("positional", (x, y, out, 4096, 1024), dict()),
+        ("keywords", (x, y, out), dict(n=4096, BLOCK=1024, num_warps=4)),
+    ]
+    print(f"{'call':>12}{'binder (us)':>14}{'native key (us)':>18}")
+    for name, kernel_args, kernel_kwargs in calls:
+        add_kernel.key_hasher = None
+        slow = bench(kernel_args, kernel_kwargs, args.calls)
+        add_kernel.key_hasher = key_hasher
+        fast = bench(kernel_args, kernel_kwargs, args.calls)
+        print(f"{name:>12}{slow * 1e6:>14.2f}{fast * 1e6:>18.2f}")
+
+
+if __name__ == "__main__":
+    main()
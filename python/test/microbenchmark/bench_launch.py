@@ -0,0 +1,101 @@
+"""
+Measures the host overhead of launching a kernel through the CUDA launcher
+(`make_launcher`), from the Python call to the driver call, for signatures
+with scalars, pointers, constexprs and tuples.
+
+The benchmark runs against a stub libcuda, whose functions do nothing and
+return CUDA_SUCCESS, so it needs neither a GPU nor a CUDA driver: it compiles
+the stub with `cc` and re-executes itself with the stub first on the library
+path. Pointers are passed as integers, so the time excludes `data_ptr()`.
+
+Usage: python bench_launch.py [--launches 1000000]
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+# Every CUDA driver function that cuda_utils links against or loads.
+STUB_FUNCTIONS = [
+    "cuCtxEnablePeerAccess",
+    "cuCtxGetCurrent",
+    "cuCtxGetDevice",
+    "cuCtxGetLimit",
+    "cuCtxSetCurrent",
+    "cuCtxSetLimit",
+    "cuDeviceGet",
+    "cuDeviceGetAttribute",
+    "cuDevicePrimaryCtxRetain",
+    "cuFuncGetAttribute",
+    "cuFuncSetAttribute",
+    "cuFuncSetCacheConfig",
+    "cuGetErrorString",
+    "cuLaunchKernel",
+    "cuLaunchKernelEx",
+    "cuModuleGetFunction",
+    "cuModuleLoadData",
+    "cuOccupancyMaxActiveClusters",
+    "cuPointerGetAttribute",
+    "cuTensorMapEncodeTiled",
+]
+
+STUB_ENV = "TRITON_BENCH_LAUNCH_STUB_DIR"
+
+PTR = 1 << 20
+
+
+def params(prefix, ty, num):
+    return {f"{prefix}{i}": ty for i in range(num)}
+
+
+# (name, signature, arguments) of the launched kernels.
+SIGNATURES = [
+    ("4 pointers", params("p", "*fp32", 4), (PTR, ) * 4),
+    ("4 pointers, 4 scalars", {**params("p", "*fp32", 4), **params("n", "i32", 4)}, (PTR, ) * 4 + (1024, ) * 4),
+    ("8 scalars, 4 constexprs", {**params("n", "i32", 8), **params("C", "constexpr", 4)}, (1024, ) * 8 + (64, ) * 4),
+    ("tuples", {"ptrs": ("*fp32", "*fp32", "constexpr"), "strides": ("i64", "i64"), "n": "i32", "C": "constexpr"},
+     ((PTR, PTR, 16), (64, 1), 1024, (1, 2))),
+]
+
+
+def build_stub(directory):
+    src = os.path.join(directory, "libcuda.c")
+    with open(src, "w") as f:
+        f.writelines(f"int {name}(void) {{ return 0; }}\n" for name in STUB_FUNCTIONS)
+    subprocess.check_call(["cc", "-shared", "-fPIC", "-O2", "-o", os.path.join(directory, "libcuda.so.1"), src])
+
+
+def bench(launch, args, num_launches):
+    packed_metadata = (4, 1, 0, 1, 1, 1)
+    start = time.perf_counter()
+    for _ in range(num_launches):
+        launch(1, 1, 1, 0, 0, None, packed_metadata, None, None, None, *args)
+    return (time.perf_counter() - start) / num_launches
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--launches", type=int, default=1000000)
+    args = parser.parse_args()
+
+    if STUB_ENV not in os.environ:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            build_stub(tmpdir)
+            env = dict(os.environ, **{STUB_ENV: tmpdir})
+            env["LD_LIBRARY_PATH"] = os.pathsep.join(filter(None, [tmpdir, os.environ.get("LD_LIBRARY_PATH")]))
+            sys.exit(subprocess.call([sys.executable] + sys.argv, env=env))
+
+    from triton.backends.nvidia.driver import make_launcher
+
+    print(f"{'signature':>26}{'time (us)':>12}")
+    for name, signature, kernel_args in SIGNATURES:
+        launch = make_launcher(dict(), signature)
+        elapsed = bench(launch, kernel_args, args.launches)
+        print(f"{name:>26}{elapsed * 1e6:>12.2f}")
+
+
+if __name__ == "__main__":
+    main()
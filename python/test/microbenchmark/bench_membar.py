@@ -0,0 +1,78 @@
+"""
+Measures the compile time of the shared memory barrier analysis (membar) on
+straight-line modules with many shared memory accesses, such as fully unrolled
+kernels.
+
+Each generated function stores to a number of buffers and then loads from all
+of them, for a given number of rounds. Within a round, the stores and the loads
+touch disjoint intervals, so the analysis accumulates hundreds of intervals
+between barriers.
+
+Usage: python bench_membar.py [--buffers 64 256 1024] [--rounds 4]
+"""
+
+import argparse
+import os
+import tempfile
+import time
+
+from triton._C.libtriton import ir, passes
+
+MEMDESC = "!ttg.memdesc<16x64xf16, #shared, #smem, mutable>"
+TENSOR = "tensor<16x64xf16, #blocked>"
+
+
+def make_module(num_buffers, num_rounds):
+    lines = [
+        "#blocked = #ttg.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>",
+        "#shared = #ttg.swizzled_shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>",
+        "#smem = #ttg.shared_memory",
+        'module attributes {"ttg.num-warps" = 4 : i32, "ttg.num-ctas" = 1 : i32, "ttg.threads-per-warp" = 32 : i32} {',
+        "  tt.func public @kernel() {",
+        f"    %cst = arith.constant dense<0.000000e+00> : {TENSOR}",
+    ]
+    for i in range(num_buffers):
+        lines.append(f"    %buf{i} = ttg.local_alloc : () -> {MEMDESC}")
+    for r in range(num_rounds):
+        for i in range(num_buffers):
+            lines.append(f"    ttg.local_store %cst, %buf{i} : {TENSOR} -> {MEMDESC}")
+        for i in range(num_buffers):
+            lines.append(f"    %val{r}_{i} = ttg.local_load %buf{i} : {MEMDESC} -> {TENSOR}")
+    for i in range(num_buffers):
+        lines.append(f"    ttg.local_dealloc %buf{i} : {MEMDESC}")
+    lines += ["    tt.return", "  }", "}"]
+    return "\n".join(lines)
+
+
+def run_membar(src):
+    context = ir.context()
+    ir.load_dialects(context)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, "kernel.ttgir")
+        with open(path, "w") as f:
+            f.write(src)
+        mod = ir.parse_mlir_module(path, context)
+    mod.context = context
+    allocation = passes.analysis.allocation(mod)
+    membar = passes.analysis.membar(allocation)
+    start = time.perf_counter()
+    membar.run()
+    elapsed = time.perf_counter() - start
+    return elapsed, str(mod).count("gpu.barrier")
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--buffers", type=int, nargs="+", default=[64, 256, 1024])
+    parser.add_argument("--rounds", type=int, default=4)
+    args = parser.parse_args()
+
+    print(f"{'buffers':>10}{'accesses':>10}{'time (ms)':>14}{'barriers':>10}")
+    for num_buffers in args.buffers:
+        elapsed, barriers = run_membar(make_module(num_buffers, args.rounds))
+        accesses = 2 * num_buffers * args.rounds
+        print(f"{num_buffers:>10}{accesses:>10}{elapsed * 1e3:>14.1f}{barriers:>10}")
+
+
+if __name__ == "__main__":
+    main()
@@ -1573,6 +1573,33 @@ def test_atomic_rmw_predicate(num_ctas, device):
     assert x.item() == 63
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("num_threads", [2, 8])
+def test_interpreter_parallel_grid(num_threads, device, monkeypatch):
+    if not is_interpreter():
+        pytest.skip("parallel grid execution is only available in the interpreter")
+    monkeypatch.setenv("TRITON_INTERPRET_NUM_THREADS", str(num_threads))
+
+    @triton.jit
+    def kernel(X, Y, COUNT, BLOCK: tl.constexpr):
+        pid_x = tl.program_id(0)
+        pid_y = tl.program_id(1)
+        pid = pid_x * tl.num_programs(1) + pid_y
+        offs = pid * BLOCK + tl.arange(0, BLOCK)
+        tl.store(Y + offs, tl.load(X + offs) + pid)
+        tl.atomic_add(COUNT, 1)
+
+    grid = (16, 8)
+    BLOCK = 32
+    x = torch.arange(grid[0] * grid[1] * BLOCK, device=device, dtype=torch.int32)
+    y = torch.empty_like(x)
+    count = torch.zeros((1, ), device=device, dtype=torch.int32)
+    kernel[grid](x, y, count, BLOCK=BLOCK)
+    pid = torch.arange(grid[0] * grid[1], device=device, dtype=torch.int32).repeat_interleave(BLOCK)
+    torch.testing.assert_close(y, x + pid)
+    assert count.item() == grid[0] * grid[1]
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("shape, axis, num_ctas, dtype_x_str, check_return_val",
                          [(shape, axis, num_ctas, dtype_x_str, check_return_val)
@@ -2692,6 +2719,133 @@ def test_scan_1d(M, N):
     torch.testing.assert_close(ref.to(torch.int32), output, atol=0, rtol=0)
 
 
+@triton.jit
+def _add_combine(a, b):
+    return a + b
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("shape", [(4, 128), (16, 32)])
+@pytest.mark.parametrize("axis", [0, 1])
+@pytest.mark.parametrize("reverse", [False, True])
+@pytest.mark.parametrize("exclusive", [False, True])
+@pytest.mark.parametrize("num_warps", [1, 4])
+def test_segmented_scan(shape, axis, reverse, exclusive, num_warps, device):
+
+    @triton.jit
+    def kernel(X, H, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, AXIS: tl.constexpr, REVERSE: tl.constexpr,
+               EXCLUSIVE: tl.constexpr):
+        offs = tl.arange(0, BLOCK_M)[:, None] * BLOCK_N + tl.arange(0, BLOCK_N)[None, :]
+        x = tl.load(X + offs)
+        heads = tl.load(H + offs) != 0
+        z = tl.associative_scan(x, AXIS, _add_combine, reverse=REVERSE, exclusive=EXCLUSIVE, segment_heads=heads)
+        tl.store(Z + offs, z)
+
+    rs = RandomState(17)
+    x = rs.randint(-100, 100, shape).astype(np.int32)
+    heads = rs.randint(0, 5, shape) == 0
+
+    # Scan the rows of the last dimension, in the direction of the scan.
+    xs = np.moveaxis(x, axis, -1)
+    hs = np.moveaxis(heads, axis, -1)
+    if reverse:
+        xs, hs = np.flip(xs, -1), np.flip(hs, -1)
+    ref = np.zeros_like(xs)
+    for row in np.ndindex(xs.shape[:-1]):
+        acc = 0
+        for i in range(xs.shape[-1]):
+            if hs[row + (i, )]:
+                acc = 0
+            if exclusive:
+                ref[row + (i, )] = acc
+            acc += xs[row + (i, )]
+            if not exclusive:
+                ref[row + (i, )] = acc
+    if reverse:
+        ref = np.flip(ref, -1)
+    ref = np.moveaxis(ref, -1, axis)
+
+    x_tri = to_triton(x, device=device)
+    h_tri = to_triton(heads.astype(np.int8), device=device)
+    z_tri = to_triton(np.empty_like(x), device=device)
+    kernel[(1, )](x_tri, h_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis, REVERSE=reverse,
+                  EXCLUSIVE=exclusive, num_warps=num_warps)
+    np.testing.assert_equal(ref, to_numpy(z_tri))
+
+
+@pytest.mark.interpreter
+def test_exclusive_scan_requires_add(device):
+
+    @triton.jit
+    def _max_combine(a, b):
+        return tl.maximum(a, b)
+
+    @triton.jit
+    def kernel(X, Z, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        tl.store(Z + offs, tl.associative_scan(tl.load(X + offs), 0, _max_combine, exclusive=True))
+
+    x = to_triton(np.arange(32, dtype=np.int32), device=device)
+    errc = triton.CompilationError if not is_interpreter() else InterpreterError
+    with pytest.raises(errc) as e:
+        kernel[(1, )](x, torch.empty_like(x), BLOCK=32)
+
+    assert "exclusive scans require a combine_fn that adds its arguments" in str(e.value.__cause__)
+
+
+@pytest.mark.parametrize("op, exclusive", [("addi", False), ("addi", True), ("maxsi", False)])
+def test_scan_single_lane_carry(op, exclusive, device, tmp_path: pathlib.Path):
+    # A single lane holds the axis, with several elements per thread, and the
+    # axis spans several blocks: the elements of each chunk take the carry of
+    # the previous blocks.
+    M, N = 32, 4 * THREADS_PER_WARP
+    layout = BlockedLayout([4, 1], [1, THREADS_PER_WARP], [1, 4], [0, 1])
+    attrs = "axis = 0 : i32, reverse = false" + (", exclusive" if exclusive else "")
+    ir = f"""
+    #blocked = {layout}
+    module attributes {{"ttg.num-warps" = 4 : i32, "ttg.num-ctas" = 1 : i32, "ttg.threads-per-warp" = {THREADS_PER_WARP} : i32}} {{
+    tt.func public @kernel(%arg0: !tt.ptr<i32> {{tt.divisibility = 16 : i32}}, %arg1: !tt.ptr<i32> {{tt.divisibility = 16 : i32}}) {{
+      %cst = arith.constant dense<{N}> : tensor<{M}x1xi32, #blocked>
+      %0 = tt.make_range {{end = {M} : i32, start = 0 : i32}} : tensor<{M}xi32, #ttg.slice<{{dim = 1, parent = #blocked}}>>
+      %1 = tt.expand_dims %0 {{axis = 1 : i32}} : tensor<{M}xi32, #ttg.slice<{{dim = 1, parent = #blocked}}>> -> tensor<{M}x1xi32, #blocked>
+      %2 = arith.muli %1, %cst : tensor<{M}x1xi32, #blocked>
+      %3 = tt.make_range {{end = {N} : i32, start = 0 : i32}} : tensor<{N}xi32, #ttg.slice<{{dim = 0, parent = #blocked}}>>
+      %4 = tt.expand_dims %3 {{axis = 0 : i32}} : tensor<{N}xi32, #ttg.slice<{{dim = 0, parent = #blocked}}>> -> tensor<1x{N}xi32, #blocked>
+      %5 = tt.broadcast %2 : tensor<{M}x1xi32, #blocked> -> tensor<{M}x{N}xi32, #blocked>
+      %6 = tt.broadcast %4 : tensor<1x{N}xi32, #blocked> -> tensor<{M}x{N}xi32, #blocked>
+      %7 = arith.addi %5, %6 : tensor<{M}x{N}xi32, #blocked>
+      %8 = tt.splat %arg0 : !tt.ptr<i32> -> tensor<{M}x{N}x!tt.ptr<i32>, #blocked>
+      %9 = tt.addptr %8, %7 : tensor<{M}x{N}x!tt.ptr<i32>, #blocked>, tensor<{M}x{N}xi32, #blocked>
+      %10 = tt.load %9 : tensor<{M}x{N}x!tt.ptr<i32>, #blocked>
+      %11 = "tt.scan"(%10) <{{{attrs}}}> ({{
+      ^bb0(%arg2: i32, %arg3: i32):
+        %12 = arith.{op} %arg2, %arg3 : i32
+        tt.scan.return %12 : i32
+      }}) : (tensor<{M}x{N}xi32, #blocked>) -> tensor<{M}x{N}xi32, #blocked>
+      %13 = tt.splat %arg1 : !tt.ptr<i32> -> tensor<{M}x{N}x!tt.ptr<i32>, #blocked>
+      %14 = tt.addptr %13, %7 : tensor<{M}x{N}x!tt.ptr<i32>, #blocked>, tensor<{M}x{N}xi32, #blocked>
+      tt.store %14, %11 : tensor<{M}x{N}x!tt.ptr<i32>, #blocked>
+      tt.return
+    }}
+    }}
+    """
+
+    temp_file = tmp_path / "test_scan_single_lane_carry.ttgir"
+    temp_file.write_text(ir)
+    kernel = triton.compile(str(temp_file))
+
+    rs = RandomState(17)
+    x = rs.randint(-100, 100, (M, N)).astype('int32')
+    x_tri = torch.tensor(x, device=device)
+    z_tri = torch.empty_like(x_tri)
+    kernel[(1, 1, 1)](x_tri, z_tri)
+
+    z_ref = np.cumsum(x, axis=0) if op == "addi" else np.maximum.accumulate(x, axis=0)
+    if exclusive:
+        z_ref = np.concatenate([np.zeros((1, N), dtype=x.dtype), z_ref[:-1]])
+    np.testing.assert_equal(z_ref, z_tri.cpu().numpy())
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("op", ['sum', 'max', 'min'])
 @pytest.mark.parametrize("BLOCK_N", [32, 64, 128])
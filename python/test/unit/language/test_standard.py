@@ -48,6 +48,76 @@ def test_sort(M, N, descending, dtype_str, device):
     assert (y == z).all(), (y, z)
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("M, N, K", [[1, 512, 1], [8, 64, 8], [256, 16, 2], [512, 8, 512]])
+@pytest.mark.parametrize("dtype_str", ['int32', 'float16', 'float32'])
+def test_topk(M, N, K, dtype_str, device):
+
+    @triton.jit
+    def topk_kernel(X, Z, N: tl.constexpr, M: tl.constexpr, K: tl.constexpr):
+        offx = tl.arange(0, M)
+        offy = tl.arange(0, N)
+        x = tl.load(X + offx[None, :] + offy[:, None] * M)
+        z = tl.topk(x, K)
+        tl.store(Z + tl.arange(0, K)[None, :] + offy[:, None] * K, z)
+
+    x = numpy_random((N, M), dtype_str=dtype_str)
+    x = torch.from_numpy(x).to(device)
+    y = torch.topk(x, K, dim=1)[0]
+    z = torch.empty((N, K), dtype=x.dtype, device=device)
+    topk_kernel[(1, )](x, z, N, M, K, num_warps=8)
+    assert (y == z).all(), (y, z)
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("M, N, K", [[512, 1, 8], [128, 8, 32], [64, 4, 64]])
+@pytest.mark.parametrize("dtype_str", ['int32', 'float16', 'float32'])
+def test_topk_indices(M, N, K, dtype_str, device):
+
+    @triton.jit
+    def topk_kernel(X, Z, I, N: tl.constexpr, M: tl.constexpr, K: tl.constexpr):
+        offx = tl.arange(0, M)
+        offy = tl.arange(0, N)
+        x = tl.load(X + offx[None, :] + offy[:, None] * M)
+        z, idx = tl.topk(x, K, return_indices=True)
+        tl.store(Z + tl.arange(0, K)[None, :] + offy[:, None] * K, z)
+        tl.store(I + tl.arange(0, K)[None, :] + offy[:, None] * K, idx)
+
+    x = numpy_random((N, M), dtype_str=dtype_str)
+    x = torch.from_numpy(x).to(device)
+    y = torch.topk(x, K, dim=1)[0]
+    z = torch.empty((N, K), dtype=x.dtype, device=device)
+    idx = torch.empty((N, K), dtype=torch.int32, device=device)
+    topk_kernel[(1, )](x, z, idx, N, M, K, num_warps=8)
+    assert (y == z).all(), (y, z)
+    # Ties may come in any order, but each index must point at its value, once.
+    assert (x.gather(1, idx.long()) == z).all(), (x, z, idx)
+    assert (idx.sort(dim=1)[0].diff(dim=1) > 0).all(), idx
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("descending", [False, True])
+def test_sort_topk_bfloat16(descending, device):
+    # numpy_random returns float32 data for bfloat16; use negative bfloat16
+    # values, whose bits do not sort as unsigned integers.
+
+    @triton.jit
+    def sort_topk_kernel(X, Z, T, N: tl.constexpr, M: tl.constexpr, K: tl.constexpr, descending: tl.constexpr):
+        offx = tl.arange(0, M)
+        offy = tl.arange(0, N)
+        x = tl.load(X + offx[None, :] + offy[:, None] * M)
+        tl.store(Z + offx[None, :] + offy[:, None] * M, tl.sort(x, descending=descending))
+        tl.store(T + tl.arange(0, K)[None, :] + offy[:, None] * K, tl.topk(x, K))
+
+    N, M, K = 8, 64, 8
+    x = torch.randn((N, M), dtype=torch.bfloat16, device=device) * 100
+    z = torch.empty_like(x)
+    t = torch.empty((N, K), dtype=x.dtype, device=device)
+    sort_topk_kernel[(1, )](x, z, t, N, M, K, descending, num_warps=8)
+    assert (torch.sort(x, descending=descending)[0] == z).all(), (x, z)
+    assert (torch.topk(x, K, dim=1)[0] == t).all(), (x, t)
+
+
 # ---------------
 # test flip op
 # ---------------
@@ -1,8 +1,11 @@
+import shutil
+
 import torch
 
 import triton
 import triton.language as tl
 import pytest
+from triton.runtime.cache import TuningDatabase
 
 
 def do_bench(kernel_call, quantiles):
@@ -146,6 +149,186 @@ def test_prune_configs(with_perf_model: bool, device: str):
         assert records['capture_named_args']
 
 
+def test_precompile(device):
+    N = 1024
+    src = torch.randn(N, device=device)
+    dst = torch.empty(N, device=device)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 2**i}) for i in range(5, 9)]
+    num_compiled = []
+
+    def _pre_hook(kwargs, reset_only=False):
+        kernel_cache = _kernel.fn.device_caches[triton.runtime.driver.active.get_current_device()][0]
+        num_compiled.append(len(kernel_cache))
+
+    @triton.autotune(configs=configs, key=['N'], pre_hook=_pre_hook, do_bench=do_bench)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _kernel[grid](dst, src, N=N)
+    torch.testing.assert_close(src, dst)
+    # All the configs are compiled before the first one is benchmarked.
+    assert num_compiled[0] == len(configs)
+    assert set(_kernel.configs_compile_timings) == set(configs)
+
+
+def test_precompile_failure(device, fresh_triton_cache):
+    N = 1024
+    src = torch.randn(N, device=device)
+    dst = torch.empty(N, device=device)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 2**i}) for i in range(5, 9)]
+    num_compiles = [0]
+
+    def cache_hook(*args, **kwargs):
+        num_compiles[0] += 1
+
+    @triton.autotune(configs=configs, key=['N'], do_bench=do_bench)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        tl.static_assert(BLOCK_SIZE < 256)
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    triton.runtime.jit.JITFunction.cache_hook = cache_hook
+    try:
+        _kernel[grid](dst, src, N=N)
+    finally:
+        triton.runtime.jit.JITFunction.cache_hook = None
+    torch.testing.assert_close(src, dst)
+    # The config that fails to compile is not compiled again to benchmark it.
+    assert num_compiles[0] == len(configs)
+    assert set(_kernel.compile_errors) == {configs[-1]}
+    assert _kernel.configs_timings[configs[-1]] == [float("inf")] * 3
+
+
+def test_resource_limits(device):
+    N = 1024
+    src = torch.randn(N, device=device)
+    dst = torch.empty(1, device=device)
+    # A reduction across warps goes through shared memory, and one within a warp doesn't.
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': N}, num_warps=w) for w in (1, 2, 4, 8)]
+
+    @triton.autotune(configs=configs, key=['N'], prune_configs_by={'resource_limits': {'shared': 0}},
+                     do_bench=do_bench)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst, tl.sum(x, axis=0))
+
+    _kernel[(1, )](dst, src, N=N)
+    torch.testing.assert_close(src.sum().reshape(1), dst)
+    resources = _kernel.configs_resources
+    assert set(resources) == set(configs)
+    assert resources[configs[0]]['shared'] == 0
+    assert all(resources[c]['shared'] > 0 for c in configs[1:])
+    assert all(resources[c]['registers'] > 0 for c in configs)
+    assert set(_kernel.configs_timings) == {configs[0]}
+    # The estimate is the allocation of the compiled kernel.
+    kernel = _kernel.fn.warmup(dst, src, N, grid=(1, ), **configs[-1].all_kwargs())
+    assert kernel.metadata.shared == resources[configs[-1]]['shared']
+
+
+def test_resource_limits_registers():
+    # The register count is only an estimate, so configs can't be dropped by it.
+
+    @triton.jit
+    def _kernel(dst):
+        pass
+
+    with pytest.raises(ValueError, match="registers"):
+        triton.autotune(configs=[triton.Config({})], key=[],
+                        prune_configs_by={'resource_limits': {'registers': 255}})(_kernel)
+
+
+def test_cache_results(device, fresh_triton_cache, tmp_path):
+    N = 1024
+    src = torch.randn(N, device=device)
+    dst = torch.empty(N, device=device)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 2**i}) for i in range(5, 9)]
+    num_benchmarks = [0]
+
+    def mock_do_bench(kernel_call, quantiles):
+        # Each config is faster than the previous one.
+        num_benchmarks[0] += 1
+        return [1.0 / num_benchmarks[0]] * len(quantiles)
+
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    def autotuned():
+        return triton.autotune(configs=configs, key=['N'], cache_results=True, do_bench=mock_do_bench)(_kernel)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    kernel = autotuned()
+    kernel[grid](dst, src, N=N)
+    kernel[grid](dst, src, N=N // 2)
+    assert num_benchmarks[0] == 2 * len(configs)
+    assert kernel.best_config is configs[-1]
+
+    # A new autotuner, as in a new process, reads the results back.
+    kernel = autotuned()
+    kernel[grid](dst, src, N=N)
+    torch.testing.assert_close(src, dst)
+    assert num_benchmarks[0] == 2 * len(configs)
+    assert kernel.best_config is configs[-1]
+
+    # Results move to another cache directory through export and import.
+    path = str(tmp_path / "tuning.json")
+    assert TuningDatabase().export(path) == 2
+    shutil.rmtree(TuningDatabase().cache.cache_dir)
+    assert TuningDatabase().import_(path) == 2
+    kernel = autotuned()
+    kernel[grid](dst, src, N=N // 2)
+    assert num_benchmarks[0] == 2 * len(configs)
+
+
+def test_cache_results_rebuilt_configs(device, fresh_triton_cache):
+    N = 1024
+    src = torch.randn(N, device=device)
+    dst = torch.empty(N, device=device)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 2**i}) for i in range(5, 9)]
+    num_benchmarks = [0]
+
+    def mock_do_bench(kernel_call, quantiles):
+        num_benchmarks[0] += 1
+        return [1.0 / num_benchmarks[0]] * len(quantiles)
+
+    def early_config_prune(configs, named_args, **kwargs):
+        # Returns copies, which are not the configs passed to autotune.
+        return [triton.Config(dict(config.kwargs), num_warps=config.num_warps) for config in configs]
+
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    def autotuned():
+        return triton.autotune(configs=configs, key=['N'], cache_results=True, do_bench=mock_do_bench,
+                               prune_configs_by={'early_config_prune': early_config_prune})(_kernel)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    kernel = autotuned()
+    kernel[grid](dst, src, N=N)
+    assert num_benchmarks[0] == len(configs)
+
+    # The best config is matched back to `configs` by value.
+    kernel = autotuned()
+    kernel[grid](dst, src, N=N)
+    torch.testing.assert_close(src, dst)
+    assert num_benchmarks[0] == len(configs)
+    assert kernel.best_config is configs[-1]
+
+
 def test_exceed_tmem(device):
     if not torch.cuda.is_available() or not torch.cuda.get_device_capability()[0] == 10:
         pytest.skip("Test requires tensor memory.")
@@ -1,5 +1,8 @@
 import importlib.util
+import inspect
 import itertools
+import json
+import os
 import shutil
 import pathlib
 
@@ -8,6 +11,7 @@ import torch
 
 import triton
 import triton.language as tl
+from triton.runtime.cache import PackedCacheManager
 from triton.runtime.jit import JITFunction
 from triton._internal_testing import is_hip
 
@@ -60,6 +64,11 @@ def kernel_nospec_on_alignment(X, i, BLOCK: tl.constexpr):
     tl.store(X, i)
 
 
+@triton.jit
+def kernel_fma(X, Y):
+    tl.store(X, tl.load(X) * tl.load(Y) + 1.0)
+
+
 @triton.jit
 def kernel_with_combine_fn(X, BLOCK: tl.constexpr):
     i = tl.arange(0, BLOCK)
@@ -152,6 +161,48 @@ def test_changed_line_numbers_invalidate_cache(tmp_path: pathlib.Path):
     assert orig_cache_key != updated_cache_key
 
 
+def test_triton_key_sources(tmp_path: pathlib.Path):
+    from triton.compiler.compiler import _python_sources
+    # Editable installs symlink the backends into the tree.
+    backend_dir = tmp_path / "backend"
+    backend_dir.mkdir()
+    (backend_dir / "compiler.py").write_text("")
+    tree = tmp_path / "backends"
+    tree.mkdir()
+    (tree / "compiler.py").write_text("")
+    (tree / "nvidia").symlink_to(backend_dir, target_is_directory=True)
+    assert _python_sources(str(tree)) == [str(tree / "compiler.py"), str(tree / "nvidia" / "compiler.py")]
+
+    sources = {os.path.realpath(path) for path in _python_sources(os.path.dirname(triton.backends.__file__))}
+    for name, backend in triton.backends.backends.items():
+        assert os.path.realpath(inspect.getfile(backend.compiler)) in sources, name
+        assert os.path.realpath(inspect.getfile(backend.driver)) in sources, name
+
+
+def test_file_digests(fresh_triton_cache, tmp_path: pathlib.Path):
+    from triton.runtime.cache import get_file_digests
+    source = tmp_path / "source.py"
+    source.write_text("a = 1\n")
+    digest = get_file_digests([str(source)])[0]
+    assert get_file_digests([str(source)]) == [digest]
+    source.write_text("a = 10\n")
+    new_digest = get_file_digests([str(source)])[0]
+    assert new_digest != digest
+    # A write that keeps the size and modification time of a file that was
+    # hashed within the same second is still seen.
+    mtime_ns = source.stat().st_mtime_ns
+    source.write_text("a = 20\n")
+    os.utime(source, ns=(mtime_ns, mtime_ns))
+    assert get_file_digests([str(source)]) != [new_digest]
+    # The file is replaced atomically, and keeps the entries of other files.
+    other = tmp_path / "other.py"
+    other.write_text("b = 1\n")
+    get_file_digests([str(other)])
+    cache_dir = pathlib.Path(fresh_triton_cache)
+    assert not list(cache_dir.glob("file_digests.json.tmp*"))
+    assert set(json.loads((cache_dir / "file_digests.json").read_text())) == {str(source), str(other)}
+
+
 def test_reuse(device, fresh_triton_cache):
     counter = 0
 
@@ -183,6 +234,59 @@ def test_specialize(mode, device, fresh_triton_cache):
     assert counter == target
 
 
+def test_key_hasher(device, fresh_triton_cache):
+    counter = 0
+
+    def inc_counter(*args, **kwargs):
+        nonlocal counter
+        counter += 1
+
+    @triton.jit
+    def kernel(X, i, BLOCK: tl.constexpr):
+        tl.store(X, i)
+
+    JITFunction.cache_hook = inc_counter
+    x = torch.empty(64, dtype=torch.int32, device=device)
+    y = torch.empty(64, dtype=torch.float32, device=device)
+    kernel[(1, )](x, 16, BLOCK=512)
+    key_hasher = kernel.key_hasher
+    if key_hasher is None:
+        pytest.skip("the backend specializes arguments in Python")
+    # Calls with the same specialization have the same key.
+    assert key_hasher((x, 32), dict(BLOCK=512)) == key_hasher((x, 16), dict(BLOCK=512))
+    assert key_hasher((x, 16), dict(BLOCK=512)) != key_hasher((x[1:], 16), dict(BLOCK=512))
+    assert key_hasher((x, 16), dict(BLOCK=512)) != key_hasher((y, 16), dict(BLOCK=512))
+    assert key_hasher((x, 16), dict(BLOCK=512)) != key_hasher((x, 1), dict(BLOCK=512))
+    assert key_hasher((x, 16), dict(BLOCK=512)) != key_hasher((x, 16), dict(BLOCK=256))
+    assert key_hasher((x, 16), dict(BLOCK=kernel)) is None
+    for i in [16, 32, 48]:
+        kernel[(1, )](x, i, BLOCK=512)
+        kernel[(1, )](x[1:], i, BLOCK=512)
+    assert counter == 2
+    # Clearing the kernel cache also invalidates the native keys.
+    device = getattr(torch, device).current_device()
+    kernel.device_caches[device][0].clear()
+    kernel[(1, )](x, 16, BLOCK=512)
+    assert counter == 3
+
+
+def test_options_env_change(device, fresh_triton_cache, monkeypatch):
+    # The options that parse_options reads from the environment are part of
+    # the kernel key, on both the binder and the native key paths.
+    x = torch.ones(1, dtype=torch.float32, device=device)
+    y = torch.ones(1, dtype=torch.float32, device=device)
+    monkeypatch.setenv("TRITON_DEFAULT_FP_FUSION", "1")
+    fused = kernel_fma[(1, )](x, y)
+    assert kernel_fma[(1, )](x, y) is fused
+    monkeypatch.setenv("TRITON_DEFAULT_FP_FUSION", "0")
+    unfused = kernel_fma[(1, )](x, y)
+    assert unfused is not fused
+    assert kernel_fma[(1, )](x, y) is unfused
+    assert fused.metadata.enable_fp_fusion and not unfused.metadata.enable_fp_fusion
+    monkeypatch.setenv("TRITON_DEFAULT_FP_FUSION", "1")
+    assert kernel_fma[(1, )](x, y) is fused
+
+
 def test_annotation(device):
 
     @triton.jit
@@ -516,6 +620,63 @@ def test_preload(device, fresh_triton_cache) -> None:
         kernel_sub.preload(specialization_data)
 
 
+def test_packed_cache_manager(fresh_triton_cache) -> None:
+    key = "A" * 52
+    manager = PackedCacheManager(key)
+    assert manager.get_group("kernel.json") is None
+    manager.begin_group("kernel.json")
+    group = {
+        "kernel.ttir": manager.put("ttir", "kernel.ttir"),
+        "kernel.cubin": manager.put(b"\x00\x01", "kernel.cubin"),
+        "kernel.json": manager.put("{}", "kernel.json", binary=False),
+    }
+    manager.put_group("kernel.json", group)
+    # the whole group is a single file
+    assert [p.name for p in pathlib.Path(fresh_triton_cache).rglob("*") if p.is_file()] == [f"{key}.pack"]
+
+    group = PackedCacheManager(key).get_group("kernel.json")
+    assert group["kernel.ttir"].read_text() == "ttir"
+    assert group["kernel.cubin"].read_bytes() == b"\x00\x01"
+    assert group["kernel.json"].read_text() == "{}"
+    assert PackedCacheManager(key).get_group("other.json") is None
+    # files that are needed as paths are copied out of the pack
+    assert pathlib.Path(PackedCacheManager(key).get_file("kernel.ttir")).read_text() == "ttir"
+
+
+def test_packed_cache(device, fresh_triton_cache, monkeypatch) -> None:
+    monkeypatch.setattr(triton.runtime.cache, "__cache_cls", PackedCacheManager)
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) + tl.load(b + idx))
+
+    compiled = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1, ))
+    assert len(list(pathlib.Path(fresh_triton_cache).glob("packs/*/*.pack"))) == 1
+    assert not list(pathlib.Path(fresh_triton_cache).rglob("*.ttgir"))
+
+    kernel_add.device_caches[getattr(torch, device).current_device()][0].clear()
+    cached = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1, ))
+    assert cached.kernel == compiled.kernel
+    assert cached.asm["ttgir"] == compiled.asm["ttgir"]
+
+
+def test_asm_after_eviction(device, fresh_triton_cache) -> None:
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) + tl.load(b + idx))
+
+    compiled = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1, ))
+    stages = set(compiled.asm)
+    assert "ttgir" in stages and len(compiled.asm) == len(stages)
+    # The stages of a FileCacheManager are read when the kernel is loaded.
+    shutil.rmtree(fresh_triton_cache)
+    assert compiled.asm.get("ttgir") == dict(compiled.asm.items())["ttgir"]
+    assert set(compiled.asm.keys()) == stages
+
+
 def test_hooks(device, fresh_triton_cache) -> None:
 
     @triton.jit
@@ -1,4 +1,5 @@
 import glob
+import json
 import os
 import subprocess
 import sys
@@ -340,6 +341,57 @@ def test_compile_link_matmul():
         np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.0)
 
 
+def test_compile_batch_link_matmul():
+    np.random.seed(3)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+        BM, BN, BK = 16, 16, 16
+
+        kernel_path = write_triton_kernels(tmp_dir, kernel_src, kernel_utils_src)
+        entries = []
+        for ha in ["", ":16"]:
+            for hb in ["", ":16"]:
+                sig = f"*fp32:16, *{dtype}:16, *{dtype}:16, i32, i32, i32, i32{ha}, i32:1, i32{hb}, i32:1, i32:16, i32:1, {BM}, {BN}, {BK}"
+                entries.append({
+                    "path": kernel_path,
+                    "kernel_name": "kernel",
+                    "signature": sig,
+                    "num_warps": 1,
+                    "grid": f"M/{BM}, N/{BN}, 1",
+                    "out_name": f"matmul_{dtype}",
+                })
+        # duplicated entries are only compiled once
+        entries.append(entries[0])
+        manifest_path = os.path.join(tmp_dir, "manifest.json")
+        with open(manifest_path, "w") as file:
+            json.dump(entries, file)
+        compiler_path = os.path.join(triton.tools.__path__[0], "compile_batch.py")
+        result = subprocess.run([sys.executable, compiler_path, manifest_path, "-j", "4", "-o", tmp_dir], check=True,
+                                cwd=tmp_dir, capture_output=True, text=True)
+        assert "compiled 5 entries (4 distinct)" in result.stdout
+        link_aot_kernels(tmp_dir)
+
+        # compile test case
+        M, N, K = 16, 16, 16
+        gen_kernel_library(tmp_dir, "libkernel.so")
+        gen_test_bin(tmp_dir, M, N, K)
+
+        # initialize test data
+        a, b, a_path, b_path, c_path = generate_matmul_test_data(tmp_dir, M, N, K)
+
+        # run test case
+        env = os.environ.copy()
+        env["LD_LIBRARY_PATH"] = tmp_dir
+        subprocess.run(["./test", a_path, b_path, c_path], env=env, check=True, cwd=tmp_dir)
+
+        # read data and compare against reference
+        c = np.genfromtxt(c_path, delimiter=",", dtype=np.int32)
+        c_tri = c.reshape((M, N)).view(np.float32)
+        c_ref = np.matmul(a.astype(np.float32), b.astype(np.float32))
+        np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.0)
+
+
 def test_launcher_has_no_available_kernel():
     np.random.seed(3)
 
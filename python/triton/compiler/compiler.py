@@ -1,12 +1,12 @@
 from __future__ import annotations
 import hashlib
 import json
-from .._C.libtriton import get_cache_invalidating_env_vars, ir
+from .._C.libtriton import get_cache_invalidating_env_vars, ir, passes
 from ..backends import backends
 from ..backends.compiler import GPUTarget
 from .. import __version__
 from ..runtime.autotuner import OutOfResources
-from ..runtime.cache import get_cache_manager, get_dump_manager, get_override_manager
+from ..runtime.cache import get_cache_manager, get_dump_manager, get_file_digests, get_override_manager
 from ..runtime.driver import driver
 from ..tools.disasm import get_sass
 # TODO: this shouldn't be here
@@ -126,39 +126,40 @@ class IRSource:
         return dict()
 
 
+def _libtriton_digest(path):
+    # The build writes the digest of libtriton next to it (see
+    # cmake/WriteFileDigest.cmake), which saves hashing it at start-up.
+    digest_path = f"{path}.sha256"
+    try:
+        digest, size = Path(digest_path).read_text().split()
+        if int(size) == os.path.getsize(path) and os.path.getmtime(digest_path) >= os.path.getmtime(path):
+            return digest
+    except (OSError, ValueError):
+        pass
+    return get_file_digests([path])[0]
+
+
+def _python_sources(path):
+    # Editable installs symlink the backends (triton/backends/<name>) and their
+    # language extras (triton/language/extra/<name>) into the tree.
+    return sorted(
+        os.path.join(root, f) for root, _, files in os.walk(path, followlinks=True) for f in files if f.endswith(".py"))
+
+
 @functools.lru_cache()
 def triton_key():
-    import pkgutil
     TRITON_PATH = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
-    contents = []
     # frontend
-    with open(__file__, "rb") as f:
-        contents += [hashlib.sha256(f.read()).hexdigest()]
+    sources = [__file__]
     # compiler
-    path_prefixes = [
-        (os.path.join(TRITON_PATH, "compiler"), "triton.compiler."),
-        (os.path.join(TRITON_PATH, "backends"), "triton.backends."),
-    ]
-    for path, prefix in path_prefixes:
-        for lib in pkgutil.walk_packages([path], prefix=prefix):
-            with open(lib.module_finder.find_spec(lib.name).origin, "rb") as f:
-                contents += [hashlib.sha256(f.read()).hexdigest()]
-
+    sources += _python_sources(os.path.join(TRITON_PATH, "compiler"))
+    sources += _python_sources(os.path.join(TRITON_PATH, "backends"))
+    contents = get_file_digests(sources)
     # backend
-    libtriton_hash = hashlib.sha256()
     ext = sysconfig.get_config_var("EXT_SUFFIX").split(".")[-1]
-    with open(os.path.join(TRITON_PATH, "_C", f"libtriton.{ext}"), "rb") as f:
-        while True:
-            chunk = f.read(1024**2)
-            if not chunk:
-                break
-            libtriton_hash.update(chunk)
-    contents.append(libtriton_hash.hexdigest())
+    contents.append(_libtriton_digest(os.path.join(TRITON_PATH, "_C", f"libtriton.{ext}")))
     # language
-    language_path = os.path.join(TRITON_PATH, 'language')
-    for lib in pkgutil.walk_packages([language_path], prefix="triton.language."):
-        with open(lib.module_finder.find_spec(lib.name).origin, "rb") as f:
-            contents += [hashlib.sha256(f.read()).hexdigest()]
+    contents += get_file_digests(_python_sources(os.path.join(TRITON_PATH, "language")))
     return f'{__version__}' + '-'.join(contents)
 
 
@@ -248,6 +249,7 @@ def compile(src, target=None, options=None):
     if not always_compile and metadata_path is not None:
         # cache hit!
         return CompiledKernel(src, metadata_group, hash)
+    fn_cache_manager.begin_group(metadata_filename)
     # initialize metadata
     metadata = {
         "hash": hash,
@@ -312,6 +314,46 @@ def compile(src, target=None, options=None):
     return CompiledKernel(src, metadata_group, hash)
 
 
+def estimate_resources(src, target=None, options=None):
+    """
+    Returns static estimates of the resources used by the kernel of `src` (an
+    `ASTSource`), computed on its TritonGPU IR. Nothing is lowered to LLVM or
+    written to the cache, and no device is needed when `target` is given. The
+    estimates are:
+
+    - `shared`: the shared memory, in bytes, from the allocation analysis,
+      which includes the buffers of the software pipeline;
+    - `registers`: the 32-bit registers per thread held by the tensors live at
+      the same time, which is only an estimate of the registers of the
+      compiled kernel and can be higher or lower;
+    - `num_warps` and `num_stages`: the launch width and pipeline depth.
+    """
+    assert isinstance(src, ASTSource), "resources can only be estimated from the AST"
+    if target is None:
+        target = driver.active.get_current_target()
+    backend = make_backend(target)
+    options = backend.parse_options(dict(options or dict(), **src.parse_options()))
+    metadata = {"target": target, **options.__dict__}
+    stages = dict()
+    backend.add_stages(stages, options)
+    context = ir.context()
+    ir.load_dialects(context)
+    backend.load_dialects(context)
+    try:
+        module = src.make_ir(options, backend.get_codegen_implementation(options), backend.get_module_map(), context)
+    except Exception as e:
+        filter_traceback(e)
+        raise
+    for ext in ("ttir", "ttgir"):
+        module = stages[ext](module, metadata)
+    return {
+        "shared": passes.analysis.allocation(module).get_shared_memory_size(),
+        "registers": passes.analysis.estimate_register_pressure(module),
+        "num_warps": options.num_warps,
+        "num_stages": options.num_stages,
+    }
+
+
 def make_backend(target):
     actives = [x.compiler for x in backends.values() if x.compiler.supports_target(target)]
     if len(actives) != 1:
@@ -337,10 +379,22 @@ class LazyDict:
 
 
 class AsmDict(dict):
+    """
+    Maps each stage to its IR. The stages in `files` that are not loaded yet
+    are read from their file on first access.
+    """
+
+    def __init__(self, files, binary_ext):
+        super().__init__()
+        self.files = files
+        self.binary_ext = binary_ext
 
     def __missing__(self, key):
 
-        if key == "sass":
+        if key in self.files:
+            file = self.files[key]
+            value = file.read_bytes() if key == self.binary_ext else file.read_text()
+        elif key == "sass":
             value = get_sass(self["cubin"])
         else:
             raise KeyError("Unknown key: '%s'" % key)
@@ -348,6 +402,33 @@ class AsmDict(dict):
         self[key] = value
         return value
 
+    def load(self):
+        """Reads all the stages that are not loaded yet."""
+        for key in self.files:
+            self[key]
+
+    def __contains__(self, key):
+        return super().__contains__(key) or key in self.files
+
+    def __iter__(self):
+        yield from self.files
+        yield from (key for key in super().__iter__() if key not in self.files)
+
+    def __len__(self):
+        return len(self.files) + sum(1 for key in super().__iter__() if key not in self.files)
+
+    def get(self, key, default=None):
+        return self[key] if key in self else default
+
+    def keys(self):
+        return list(self)
+
+    def values(self):
+        return [self[key] for key in self]
+
+    def items(self):
+        return [(key, self[key]) for key in self]
+
 
 class CompiledKernel:
 
@@ -358,8 +439,10 @@ class CompiledKernel:
 
     def __init__(self, src, metadata_group, hash):
         from collections import namedtuple
-        metadata_path = next((Path(p) for c, p in metadata_group.items() if c.endswith(".json")))
-        metadata = json.loads(metadata_path.read_text())
+        # Cache managers give either paths or file objects with the reading methods of Path.
+        files = {c: Path(p) if isinstance(p, str) else p for c, p in metadata_group.items()}
+        metadata_file = next((p for c, p in files.items() if c.endswith(".json")))
+        metadata = json.loads(metadata_file.read_text())
         metadata['cluster_dims'] = tuple(metadata['cluster_dims'])
         # JSON serialization dumps the target as a dict. Restore it to a GPUTarget.
         target = metadata['target']
@@ -372,12 +455,14 @@ class CompiledKernel:
         self.hash = hash
         self.name = self.metadata.name
         # stores the text of each level of IR that was generated during compilation
-        asm_files = [Path(p) for c, p in metadata_group.items() if not c.endswith(".json")]
+        asm_files = {Path(c).suffix[1:]: p for c, p in files.items() if not c.endswith(".json")}
         binary_ext = backend.binary_ext
-        self.asm = AsmDict({
-            file.suffix[1:]: file.read_bytes() if file.suffix[1:] == binary_ext else file.read_text()
-            for file in asm_files
-        })
+        self.asm = AsmDict(asm_files, binary_ext)
+        # The files of a FileCacheManager can be evicted, or be in a temporary
+        # cache directory, so they are read now. Other cache managers give
+        # file objects that stay readable, which are read on first access.
+        if all(isinstance(p, str) for p in metadata_group.values()):
+            self.asm.load()
         self.kernel = self.asm[binary_ext]
         # binaries are lazily initialized
         # because it involves doing runtime things
@@ -16,7 +16,6 @@ from .standard import (
     ravel,
     sigmoid,
     softmax,
-    sort,
     sum,
     swizzle2d,
     xor_sum,
@@ -95,12 +94,14 @@ from .core import (
     reduce,
     reshape,
     slice,
+    sort,
     split,
     static_assert,
     static_print,
     static_range,
     store,
     tensor,
+    topk,
     trans,
     tuple,
     tuple_type,
@@ -247,6 +248,7 @@ __all__ = [
     "sum",
     "swizzle2d",
     "tensor",
+    "topk",
     "trans",
     "tuple",
     "uint16",
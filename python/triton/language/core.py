@@ -1110,7 +1110,7 @@ class tensor(_value):
     def reduce(self, axis, combine_fn, keep_dims=False) -> tensor:
         ...
 
-    def associative_scan(self, axis, combine_fn, reverse=False) -> tensor:
+    def associative_scan(self, axis, combine_fn, reverse=False, exclusive=False, segment_heads=None) -> tensor:
         ...
 
     def gather(self, indices, axis) -> tensor:
@@ -1158,6 +1158,9 @@ class tensor(_value):
     def sort(self, dim: constexpr = None, descending: constexpr = CONSTEXPR_0) -> tensor:
         ...
 
+    def topk(self, k: constexpr, dim: constexpr = None, return_indices: constexpr = False) -> tensor:
+        ...
+
     def flip(self, dim=None) -> tensor:
         ...
 
@@ -2416,7 +2419,8 @@ def _add_scan_docstr(name: str) -> Callable[[T], T]:
 
 @_tensor_member_fn
 @builtin
-def associative_scan(input, axis, combine_fn, reverse=False, _builder=None, _generator=None):
+def associative_scan(input, axis, combine_fn, reverse=False, exclusive=False, segment_heads=None, _builder=None,
+                     _generator=None):
     """Applies the combine_fn to each elements with a carry in :code:`input` tensors along the provided :code:`axis` and update the carry
 
     :param input: the input tensor, or tuple of tensors
@@ -2427,10 +2431,19 @@ def associative_scan(input, axis, combine_fn, reverse=False, _builder=None, _gen
     :type combine_fn: Callable
     :param reverse: whether to apply the associative scan in the reverse direction along axis
     :type reverse: bool
+    :param exclusive: whether each element only combines the elements before it, in which case the first element (of the
+        scan, or of a segment) is zero. Zero is only the identity of an addition, so :code:`combine_fn` must then add
+        its arguments
+    :type exclusive: bool
+    :param segment_heads: a boolean tensor of the shape of :code:`input`. The scan starts over at each element whose flag
+        is set, in the direction of the scan
+    :type segment_heads: Tensor
 
     """
+    exclusive = _constexpr_to_value(exclusive)
     if isinstance(input, tensor):
-        return associative_scan((input, ), axis, combine_fn, reverse, _builder=_builder, _generator=_generator)[0]
+        return associative_scan((input, ), axis, combine_fn, reverse, exclusive, segment_heads, _builder=_builder,
+                                _generator=_generator)[0]
 
     def make_combine_region(scan_op):
         param_types = [t.type.scalar for t in input] * 2
@@ -2449,7 +2462,7 @@ def associative_scan(input, axis, combine_fn, reverse=False, _builder=None, _gen
     axis = _constexpr_to_value(axis)
     if axis is not None:
         axis = _wrap_axis(axis, len(input[0].shape))
-    return semantic.associative_scan(input, axis, make_combine_region, reverse, _builder)
+    return semantic.associative_scan(input, axis, make_combine_region, reverse, _builder, exclusive, segment_heads)
 
 
 @_tensor_member_fn
@@ -2484,6 +2497,54 @@ def gather(src, index, axis, _builder=None):
     return semantic.gather(src, index, axis, _builder)
 
 
+def _get_sort_dim(dim, shape):
+    dim = _constexpr_to_value(dim)
+    if dim is None:
+        dim = len(shape) - 1
+    assert dim == len(shape) - 1, "only minor dimension is currently supported"
+    return dim
+
+
+@_tensor_member_fn
+@builtin
+def sort(x, dim: constexpr = None, descending: constexpr = CONSTEXPR_0, _builder=None):
+    """
+    Sorts a tensor along a specified dimension.
+
+    :param x: The input tensor to be sorted.
+    :type x: Tensor
+    :param dim: The dimension along which to sort the tensor. If None, the tensor is sorted along the last dimension. Currently, only sorting along the last dimension is supported.
+    :type dim: int, optional
+    :param descending: If set to True, the tensor is sorted in descending order. If set to False, the tensor is sorted in ascending order.
+    :type descending: bool, optional
+    """
+    dim = _get_sort_dim(dim, x.shape)
+    return semantic.sort(x, dim, bool(_constexpr_to_value(descending)), _builder)
+
+
+@_tensor_member_fn
+@builtin
+def topk(x, k: constexpr, dim: constexpr = None, return_indices: constexpr = False, _builder=None):
+    """
+    Returns the :code:`k` largest elements of a tensor along a specified
+    dimension, in descending order.
+
+    If :code:`return_indices` is True, also returns the int32 positions of the
+    elements along the dimension. The order of equal elements is unspecified.
+
+    :param x: The input tensor.
+    :type x: Tensor
+    :param k: The number of elements to return, a power of two.
+    :type k: int
+    :param dim: The dimension along which to take the elements. If None, the last dimension is used. Currently, only the last dimension is supported.
+    :type dim: int, optional
+    :param return_indices: If set to True, returns a tuple of the values and their indices.
+    :type return_indices: bool, optional
+    """
+    dim = _get_sort_dim(dim, x.shape)
+    return semantic.topk(x, _constexpr_to_value(k), dim, bool(_constexpr_to_value(return_indices)), _builder)
+
+
 # -----------------------
 # Compiler Hint Ops
 # -----------------------
@@ -1731,8 +1731,8 @@ def reduction(inputs: Sequence[tl.tensor], axis: int, region_builder_fn, builder
 # ===----------------------------------------------------------------------===
 
 
-def associative_scan(inputs: Sequence[tl.tensor], axis: int, region_builder_fn, reverse: bool,
-                     builder: ir.builder) -> Tuple[tl.tensor, ...]:
+def associative_scan(inputs: Sequence[tl.tensor], axis: int, region_builder_fn, reverse: bool, builder: ir.builder,
+                     exclusive: bool = False, segment_heads: Optional[tl.tensor] = None) -> Tuple[tl.tensor, ...]:
     shape = inputs[0].type.shape
     rank = len(shape)
 
@@ -1744,9 +1744,16 @@ def associative_scan(inputs: Sequence[tl.tensor], axis: int, region_builder_fn,
     for t in inputs:
         assert t.type.shape == shape, "all scan inputs must have the same shape"
 
-    scan_op = builder.create_scan([t.handle for t in inputs], axis, reverse)
+    handles = [t.handle for t in inputs]
+    if segment_heads is not None:
+        assert segment_heads.type.shape == shape, "segment heads must have the shape of the scan inputs"
+        segment_heads = not_equal(segment_heads, 0, builder) if segment_heads.dtype != tl.int1 else segment_heads
+        handles.append(segment_heads.handle)
+
+    scan_op = builder.create_scan(handles, axis, reverse, segment_heads is not None, exclusive)
     region_builder_fn(scan_op)
-    scan_op.verify()
+    if not scan_op.verify() and exclusive:
+        raise ValueError("exclusive scans require a combine_fn that adds its arguments")
 
     return tuple(wrap_tensor(scan_op.get_result(i), inputs[i].type.scalar, shape) for i in range(len(inputs)))
 
@@ -1775,6 +1782,38 @@ def gather(src: tl.tensor, index: tl.tensor, axis: int, builder: ir.builder) ->
     return wrap_tensor(gather, src.type.scalar, index.type.shape)
 
 
+# ===----------------------------------------------------------------------===
+#                               Sort
+# ===----------------------------------------------------------------------===
+
+
+def _check_sortable(x: tl.tensor, dim: int):
+    assert x.type.is_block(), "sort expects a tensor"
+    assert x.dtype.is_int() or x.dtype.is_floating(), f"sort does not support {x.dtype}"
+    n = x.type.shape[dim]
+    assert n & (n - 1) == 0, f"sorted dimension must be a power of two, got {n}"
+
+
+def sort(x: tl.tensor, dim: int, descending: bool, builder: ir.builder) -> tl.tensor:
+    _check_sortable(x, dim)
+    is_unsigned = x.dtype.is_int_unsigned() or x.dtype.is_bool()
+    return tl.tensor(builder.create_sort(x.handle, dim, descending, is_unsigned), x.type)
+
+
+def topk(x: tl.tensor, k: int, dim: int, return_indices: bool, builder: ir.builder):
+    _check_sortable(x, dim)
+    assert k > 0 and k & (k - 1) == 0 and k <= x.type.shape[dim], \
+        f"k must be a power of two no larger than {x.type.shape[dim]}, got {k}"
+    is_unsigned = x.dtype.is_int_unsigned() or x.dtype.is_bool()
+    shape = list(x.type.shape)
+    shape[dim] = k
+    results = builder.create_topk(x.handle, k, dim, is_unsigned, return_indices)
+    values = tl.tensor(results[0], tl.block_type(x.dtype, shape))
+    if not return_indices:
+        return values
+    return values, tl.tensor(results[1], tl.block_type(tl.int32, shape))
+
+
 # ===----------------------------------------------------------------------===
 #                               Histogram
 # ===----------------------------------------------------------------------===
@@ -1,12 +1,15 @@
 from __future__ import annotations
 
 import builtins
+import hashlib
 import os
 import time
 import inspect
+from concurrent.futures import ThreadPoolExecutor
 from typing import Dict, Tuple, List, Optional
 
-from .jit import KernelInterface
+from .jit import KernelInterface, JITFunction
+from .cache import TuningDatabase
 from .errors import OutOfResources, PTXASError
 from .driver import driver
 
@@ -28,12 +31,14 @@ class Autotuner(KernelInterface):
         rep=None,
         use_cuda_graph=False,
         do_bench=None,
+        cache_results=False,
     ):
         """
         :param prune_configs_by: a dict of functions that are used to prune configs, fields:
             'perf_model': performance model used to predicate running time with different configs, returns running time
             'top_k': number of configs to bench
             'prune_num_stages_by'(optional): a function used to prune num_stages. It takes configs:List[Config] as its input, and returns pruned configs.
+            'resource_limits'(optional): a dict of upper bounds on the exact static resources of a config.
         """
         if not configs:
             self.configs = [Config({}, num_warps=4, num_stages=3, num_ctas=1)]
@@ -41,6 +46,9 @@ class Autotuner(KernelInterface):
             self.configs = configs
         self.keys = key
         self.cache: Dict[Tuple, Config] = {}
+        # Configs that failed to compile in the last `_precompile`.
+        self.compile_errors: Dict[Config, Exception] = {}
+        self.cache_results = cache_results or os.getenv("TRITON_CACHE_AUTOTUNING", None) == "1"
         self.arg_names = arg_names
 
         # Reset to zero or restore values
@@ -84,10 +92,18 @@ class Autotuner(KernelInterface):
         self.perf_model = None
         self.configs_top_k = 1.0
         self.early_config_prune = None
+        self.resource_limits = None
         if prune_configs_by:
             self.perf_model = prune_configs_by.get("perf_model", self.perf_model)
             self.configs_top_k = prune_configs_by.get("top_k", self.configs_top_k)
             self.early_config_prune = prune_configs_by.get("early_config_prune", self.early_config_prune)
+            self.resource_limits = prune_configs_by.get("resource_limits", self.resource_limits)
+        if self.resource_limits:
+            inexact = self.resource_limits.keys() - {"shared", "num_warps", "num_stages"}
+            if inexact:
+                raise ValueError(f"Configs can't be pruned by {', '.join(sorted(inexact))}: only shared, num_warps "
+                                 "and num_stages are known exactly before a config is compiled. The register "
+                                 "estimate is available to early_config_prune through Autotuner.estimate_resources.")
 
         self.fn = fn
         self.base_fn = fn
@@ -150,6 +166,10 @@ class Autotuner(KernelInterface):
                 config.pre_hook(full_nargs)
             self.pre_hook(full_nargs)
             try:
+                # Don't compile again a config that `_precompile` failed on.
+                error = self.compile_errors.get(config)
+                if error is not None:
+                    raise error
                 self.fn.run(
                     *args,
                     **current,
@@ -170,6 +190,71 @@ class Autotuner(KernelInterface):
                 print(f"Autotuning failed with {e}")
             return [float("inf"), float("inf"), float("inf")]
 
+    def _map_configs(self, fn, configs):
+        """
+        Returns `{config: fn(config)}` for each of `configs`, computed on the
+        pool of compilation threads.
+        """
+        num_threads = int(os.getenv("TRITON_AUTOTUNE_COMPILE_THREADS", "0"))
+        if num_threads <= 0:
+            # Each compilation runs its MLIR passes on a thread pool of its
+            # own, so a few threads already keep all the cores busy.
+            num_threads = builtins.min(8, os.cpu_count() or 1)
+        num_threads = builtins.min(num_threads, len(configs))
+        # The current device is thread-local.
+        device = driver.active.get_current_device()
+
+        def run(config):
+            driver.active.set_current_device(device)
+            return fn(config)
+
+        if num_threads <= 1:
+            return {config: fn(config) for config in configs}
+        with ThreadPoolExecutor(max_workers=num_threads) as executor:
+            return dict(zip(configs, executor.map(run, configs)))
+
+    def _precompile(self, configs, *args, **kwargs):
+        """
+        Compiles the kernel for each of `configs` concurrently, without
+        launching it, so that benchmarking finds the binaries ready. Returns
+        the compile time of each config, in seconds. The errors of configs
+        that fail to compile are kept in `compile_errors`, for `_bench` to
+        report without compiling them again.
+        """
+        errors = {}
+
+        def compile_config(config):
+            start = time.perf_counter()
+            try:
+                self.fn.run(*args, **dict(kwargs, **config.all_kwargs(), warmup=True))
+            except Exception as e:
+                errors[config] = e
+            return time.perf_counter() - start
+
+        timings = self._map_configs(compile_config, configs)
+        self.compile_errors = errors
+        return timings
+
+    def _tuning_db_key(self, key) -> Optional[str]:
+        """
+        Returns the key of the results for the autotuning `key` in the
+        `TuningDatabase`, or None if they are not persisted.
+        """
+        if not self.cache_results:
+            return None
+        fn = self.fn
+        while not isinstance(fn, JITFunction):
+            # e.g. the interpreter, whose kernels have no cache key.
+            if not hasattr(fn, "fn"):
+                return None
+            fn = fn.fn
+        configs_hash = hashlib.sha256("\n".join(str(config) for config in self.configs).encode("utf-8")).hexdigest()
+        return TuningDatabase.make_key(fn.cache_key, driver.active.get_current_target(), key, configs_hash)
+
+    def _find_config(self, value) -> Optional[Config]:
+        """Returns the config whose `Config.to_dict()` is `value`, if any."""
+        return next((config for config in self.configs if config.to_dict() == value), None)
+
     def run(self, *args, **kwargs):
         self.nargs = dict(zip(self.arg_names, args))
         used_cached_result = True
@@ -181,11 +266,19 @@ class Autotuner(KernelInterface):
                 if hasattr(arg, "dtype"):
                     key.append(str(arg.dtype))
             key = tuple(key)
+            db_key = self._tuning_db_key(key) if key not in self.cache else None
+            if db_key is not None:
+                entry = TuningDatabase().get(db_key)
+                config = self._find_config(entry["config"]) if entry is not None else None
+                if config is not None:
+                    self.cache[key] = config
             if key not in self.cache:
                 # prune configs
                 used_cached_result = False
                 pruned_configs = self.prune_configs(kwargs)
                 bench_start = time.time()
+                compile_timings = self._precompile(pruned_configs, *args, **kwargs)
+                self.compile_time = time.time() - bench_start
                 timings = {config: self._bench(*args, config=config, **kwargs) for config in pruned_configs}
                 bench_end = time.time()
                 self.bench_time = bench_end - bench_start
@@ -193,13 +286,27 @@ class Autotuner(KernelInterface):
                 full_nargs = {**self.nargs, **kwargs, **self.cache[key].all_kwargs()}
                 self.pre_hook(full_nargs, reset_only=True)
                 self.configs_timings = timings
+                self.configs_compile_timings = compile_timings
+                best = self.cache[key]
+                # A pruning function may return new configs, so the best one
+                # is persisted only if it matches one of `configs` by value.
+                if db_key is not None and self._find_config(best.to_dict()) is not None:
+                    entry = {
+                        "kernel": self.base_fn.__name__,
+                        "key": [str(k) for k in key],
+                        "config": best.to_dict(),
+                        "config_str": str(best),
+                        "timings": timings[best],
+                    }
+                    TuningDatabase().put(db_key, entry)
             config = self.cache[key]
         else:
             config = self.configs[0]
         self.best_config = config
         if os.getenv("TRITON_PRINT_AUTOTUNING", None) == "1" and not used_cached_result:
             print(f"Triton autotuning for function {self.base_fn.__name__} finished after "
-                  f"{self.bench_time:.2f}s; best config selected: {self.best_config};")
+                  f"{self.bench_time:.2f}s ({self.compile_time:.2f}s compiling); best config selected: "
+                  f"{self.best_config};")
         if config.pre_hook is not None:
             full_nargs = {**self.nargs, **kwargs, **config.all_kwargs()}
             config.pre_hook(full_nargs)
@@ -211,10 +318,40 @@ class Autotuner(KernelInterface):
         self.nargs = None
         return ret
 
+    def estimate_resources(self, config, kwargs: Dict) -> Dict:
+        """
+        Returns the static resource estimates of the kernel for `config` and
+        the current arguments (see `triton.compiler.estimate_resources`),
+        without lowering it to LLVM.
+        """
+        meta = {k: v for k, v in kwargs.items() if k not in ("grid", "warmup")}
+        return self.fn.estimate_resources(**self.nargs, **meta, **config.all_kwargs())
+
+    def _prune_by_resources(self, configs: List[Config], kwargs: Dict) -> List[Config]:
+        # The estimates run on the compilation threads. A config whose estimate
+        # fails gets the exception in `configs_resources` and is kept, as is
+        # every config if none fits: `_bench` reports their errors.
+
+        def estimate(config):
+            try:
+                return self.estimate_resources(config, kwargs)
+            except Exception as e:
+                return e
+
+        self.configs_resources = self._map_configs(estimate, configs)
+
+        def fits(config):
+            resources = self.configs_resources[config]
+            return isinstance(resources, Exception) or all(resources[k] <= v for k, v in self.resource_limits.items())
+
+        return [config for config in configs if fits(config)] or configs
+
     def prune_configs(self, kwargs: Dict) -> List[Config]:
         pruned_configs = self.configs
+        if self.resource_limits:
+            pruned_configs = self._prune_by_resources(pruned_configs, kwargs)
         if self.early_config_prune:
-            pruned_configs = self.early_config_prune(self.configs, self.nargs, **kwargs)
+            pruned_configs = self.early_config_prune(pruned_configs, self.nargs, **kwargs)
         if self.perf_model:
             top_k = self.configs_top_k
             if isinstance(top_k, float) and top_k <= 1.0:
@@ -290,6 +427,20 @@ class Config:
             }
         }
 
+    def to_dict(self):
+        """
+        Returns the values that identify the config, in a form that can be
+        written to JSON. The meta-parameters are stored by their `repr`.
+        """
+        return {
+            "kwargs": {k: repr(v)
+                       for k, v in self.kwargs.items()},
+            "num_warps": self.num_warps,
+            "num_ctas": self.num_ctas,
+            "num_stages": self.num_stages,
+            "maxnreg": self.maxnreg,
+        }
+
     def __str__(self):
         res = []
         for k, v in self.kwargs.items():
@@ -302,7 +453,7 @@ class Config:
 
 
 def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_value=None, pre_hook=None, post_hook=None,
-             warmup=None, rep=None, use_cuda_graph=False, do_bench=None):
+             warmup=None, rep=None, use_cuda_graph=False, do_bench=None, cache_results=False):
     """
     Decorator for auto-tuning a :code:`triton.jit`'d function.
 
@@ -328,6 +479,20 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_va
     :code:`"1"`, Triton will print a message to stdout after autotuning each
     kernel, including the time spent autotuning and the best configuration.
 
+    All the configurations are compiled, concurrently, before any of them is
+    benchmarked. The environment variable
+    :code:`TRITON_AUTOTUNE_COMPILE_THREADS` sets the number of compilation
+    threads (at most 8 by default). The compile time of each
+    configuration is recorded in :code:`configs_compile_timings`, next to the
+    benchmark results in :code:`configs_timings`.
+
+    With :code:`cache_results=True`, or with the environment variable
+    :code:`TRITON_CACHE_AUTOTUNING` set to :code:`"1"`, the best config for
+    each value of the key is also stored in the Triton cache directory (see
+    :code:`triton.runtime.cache.TuningDatabase`), and later processes reuse it
+    instead of benchmarking again. The results are invalidated when the
+    kernel, the target, the list of configs or the version of Triton change.
+
     :param configs: a list of :code:`triton.Config` objects
     :type configs: list[triton.Config]
     :param key: a list of argument names whose change in value will trigger the evaluation of all provided configs.
@@ -336,6 +501,13 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_va
         'perf_model': performance model used to predicate running time with different configs, returns running time
         'top_k': number of configs to bench
         'early_config_prune'(optional): a function used to do early prune (eg, num_stages). It takes configs:List[Config] as its input, and returns pruned configs.
+        'resource_limits'(optional): a dict of upper bounds, e.g. {'shared': 101376}, on the resources that
+        `triton.compiler.estimate_resources` computes from the TritonGPU IR of each config. Only `shared`,
+        `num_warps` and `num_stages` can be bounded, since the register count is only an estimate. The configs
+        that exceed them are dropped before anything is lowered to LLVM. The estimates are computed on the
+        compilation threads and kept in :code:`configs_resources`, which holds the exception instead for a config whose
+        estimate failed. :code:`Autotuner.estimate_resources` gives the same estimates, including the
+        register estimate, to the other fields.
     :param reset_to_zero: a list of argument names whose value will be reset to zero before evaluating any configs.
     :type reset_to_zero: list[str]
     :param restore_value: a list of argument names whose value will be restored after evaluating any configs.
@@ -356,12 +528,14 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_va
     :type rep: int
     :param do_bench: a benchmark function to measure the time of each run.
     :type do_bench: lambda fn, quantiles
+    :param cache_results: whether to persist the autotuning results on disk.
+    :type cache_results: bool
     """
 
     def decorator(fn):
         return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, restore_value, pre_hook=pre_hook,
                          post_hook=post_hook, prune_configs_by=prune_configs_by, warmup=warmup, rep=rep,
-                         use_cuda_graph=use_cuda_graph)
+                         use_cuda_graph=use_cuda_graph, do_bench=do_bench, cache_results=cache_results)
 
     return decorator
 
@@ -378,6 +552,11 @@ class Heuristics(KernelInterface):
             kwargs[v] = heur({**dict(zip(self.arg_names, args)), **kwargs})
         return self.fn.run(*args, **kwargs)
 
+    def estimate_resources(self, *args, **kwargs):
+        for v, heur in self.values.items():
+            kwargs[v] = heur({**dict(zip(self.arg_names, args)), **kwargs})
+        return self.fn.estimate_resources(*args, **kwargs)
+
 
 def heuristics(values):
     """
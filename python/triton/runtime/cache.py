@@ -1,10 +1,13 @@
 import importlib
 import json
+import mmap
 import os
+import struct
+import time
 import uuid
 from abc import ABC, abstractmethod
 from pathlib import Path
-from typing import Dict, List, Optional
+from typing import Dict, List, Optional, Union
 import base64
 import hashlib
 
@@ -46,6 +49,14 @@ class CacheManager(ABC):
     def put_group(self, filename: str, group: Dict[str, str]):
         pass
 
+    def begin_group(self, filename: str):
+        """
+        Notes that the files put from now on belong to the group `filename`,
+        which is complete once `put_group(filename, ...)` is called. Managers
+        may defer writing these files until then.
+        """
+        pass
+
 
 class FileCacheManager(CacheManager):
 
@@ -136,6 +147,137 @@ class FileCacheManager(CacheManager):
         return filepath
 
 
+class PackedFile:
+    """
+    A file of a pack, or one that waits to be packed. Has the reading methods
+    of `Path`; the data of a pack is only read from disk when it is accessed.
+    """
+
+    def __init__(self, data: Union[bytes, memoryview]):
+        self._data = data
+
+    def read_bytes(self) -> bytes:
+        return bytes(self._data)
+
+    def read_text(self) -> str:
+        return self.read_bytes().decode("utf-8")
+
+
+class PackedCacheManager(CacheManager):
+    """
+    Stores each group (i.e. each compiled kernel) in a single file, instead of
+    one file per IR stage plus a group index. A cache hit opens and maps one
+    file, and the stages are only read when they are accessed, so that the
+    IRs only kept for debugging are never read on a warm start.
+
+    Packs live in `packs/<2 first characters of the key>/<key>.pack` under
+    the cache directory. A pack starts with `MAGIC`, followed by the length of
+    a JSON index (64-bit little-endian), the index, and the concatenated
+    files. The index holds the name of the group and the offset and size of
+    each file, relative to the end of the index.
+
+    Files put outside of a group (e.g. compiled launchers), as well as dumps
+    and overrides, are stored one file each by a `FileCacheManager`.
+
+    Enable with TRITON_CACHE_MANAGER=triton.runtime.cache:PackedCacheManager.
+    """
+
+    MAGIC = b"TRITONPK"
+
+    def __init__(self, key, override=False, dump=False):
+        self.key = key
+        self._override = override
+        self._dump = dump
+        self._file_cache_manager = None
+        self._pending = None
+        self._pack = None
+        cache_dir = os.getenv("TRITON_CACHE_DIR", "").strip() or default_cache_dir()
+        self.pack_path = os.path.join(cache_dir, "packs", key[:2], f"{key}.pack")
+
+    def _loose(self) -> FileCacheManager:
+        # Created on demand, as it creates the cache directory of its key.
+        if self._file_cache_manager is None:
+            self._file_cache_manager = FileCacheManager(self.key, override=self._override, dump=self._dump)
+        return self._file_cache_manager
+
+    def _read_pack(self):
+        if self._pack is None:
+            try:
+                with open(self.pack_path, "rb") as f:
+                    header = f.read(len(self.MAGIC) + 8)
+                    if len(header) != len(self.MAGIC) + 8 or not header.startswith(self.MAGIC):
+                        return None
+                    (index_size, ) = struct.unpack("<Q", header[len(self.MAGIC):])
+                    index = json.loads(f.read(index_size))
+                    data = memoryview(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ))
+            except (FileNotFoundError, ValueError):
+                return None
+            start = len(header) + index_size
+            files = {
+                c: PackedFile(data[start + offset:start + offset + size])
+                for c, (offset, size) in index["files"].items()
+            }
+            self._pack = (index["group"], files)
+        return self._pack
+
+    def get_file(self, filename) -> Optional[str]:
+        if self._dump or self._override:
+            return self._loose().get_file(filename)
+        # Callers of get_file need a path, so packed files are copied out.
+        if self._pending is not None and filename in self._pending:
+            return self._loose().put(self._pending[filename].read_bytes(), filename)
+        pack = self._read_pack()
+        if pack is not None and filename in pack[1]:
+            return self._loose().put(pack[1][filename].read_bytes(), filename)
+        return self._loose().get_file(filename)
+
+    def begin_group(self, filename: str):
+        if not (self._dump or self._override):
+            self._pending = dict()
+
+    def put(self, data, filename, binary=True):
+        if self._pending is None:
+            return self._loose().put(data, filename, binary=binary)
+        if not isinstance(data, bytes):
+            data = str(data).encode("utf-8")
+        self._pending[filename] = PackedFile(data)
+        return self._pending[filename]
+
+    def get_group(self, filename: str) -> Optional[Dict[str, Union[str, PackedFile]]]:
+        if self._dump or self._override:
+            return self._loose().get_group(filename)
+        pack = self._read_pack()
+        if pack is None or pack[0] != filename:
+            return None
+        return dict(pack[1])
+
+    def put_group(self, filename: str, group: Dict[str, Union[str, PackedFile]]) -> str:
+        if self._pending is None:
+            return self._loose().put_group(filename, group)
+        index = {"group": filename, "files": dict()}
+        chunks = []
+        offset = 0
+        for c, p in group.items():
+            data = p.read_bytes() if isinstance(p, PackedFile) else Path(p).read_bytes()
+            index["files"][c] = (offset, len(data))
+            chunks.append(data)
+            offset += len(data)
+        index = json.dumps(index).encode("utf-8")
+        os.makedirs(os.path.dirname(self.pack_path), exist_ok=True)
+        # Written in one go and renamed into place, as in FileCacheManager.put.
+        temp_path = f"{self.pack_path}.tmp.pid_{os.getpid()}_{uuid.uuid4()}"
+        with open(temp_path, "wb") as f:
+            f.write(self.MAGIC)
+            f.write(struct.pack("<Q", len(index)))
+            f.write(index)
+            for chunk in chunks:
+                f.write(chunk)
+        os.replace(temp_path, self.pack_path)
+        self._pending = None
+        self._pack = None
+        return self.pack_path
+
+
 class RemoteCacheBackend:
     """
     A backend implementation for accessing a remote/distributed cache.
@@ -285,6 +427,121 @@ def get_dump_manager(key) -> CacheManager:
     return __cache_cls(_base32(key), dump=True)
 
 
+def get_file_digests(paths: List[str]) -> List[str]:
+    """
+    Returns the SHA-256 of each file of `paths`. The digests are kept in the
+    cache directory and reused while the size, modification time and inode of
+    a file are unchanged, so each version of a file is only hashed once.
+
+    A file written again within the timestamp granularity of its file system
+    keeps its modification time, so a digest recorded less than a second
+    after that time is not trusted, and the file is hashed again.
+    """
+    digests_path = os.path.join(os.getenv("TRITON_CACHE_DIR", "").strip() or default_cache_dir(), "file_digests.json")
+    try:
+        with open(digests_path) as f:
+            cached = json.load(f)
+    except (OSError, ValueError):
+        cached = dict()
+    digests = []
+    changed = False
+    # Taken before the files are read, so it is never later than a read.
+    now = time.time_ns()
+    for path in paths:
+        st = os.stat(path)
+        stamp = [st.st_size, st.st_mtime_ns, st.st_ino]
+        entry = cached.get(path)
+        if entry is None or len(entry) != 3 or entry[0] != stamp or entry[2] - st.st_mtime_ns < 10**9:
+            digest = hashlib.sha256()
+            with open(path, "rb") as f:
+                while chunk := f.read(1024**2):
+                    digest.update(chunk)
+            entry = cached[path] = [stamp, digest.hexdigest(), now]
+            changed = True
+        digests.append(entry[1])
+    if changed:
+        # The file is replaced atomically, so readers never see a partial
+        # write. The entries written by other processes since it was read are
+        # merged in; a concurrent writer can still drop some, which are then
+        # recomputed by a later process.
+        try:
+            with open(digests_path) as f:
+                cached = dict(json.load(f), **{path: cached[path] for path in paths})
+        except (OSError, ValueError, TypeError):
+            pass
+        try:
+            os.makedirs(os.path.dirname(digests_path), exist_ok=True)
+            temp_path = f"{digests_path}.tmp.pid_{os.getpid()}_{uuid.uuid4()}"
+            with open(temp_path, "w") as f:
+                json.dump(cached, f)
+            os.replace(temp_path, digests_path)
+        except OSError:
+            pass
+    return digests
+
+
+class TuningDatabase:
+    """
+    Autotuning results that persist across processes, one JSON file per entry
+    in the `autotune` directory of the cache. An entry records the best config
+    of a kernel (`JITFunction.cache_key`) on a target, for the values of the
+    autotuning key and a given space of configs.
+
+    Entries are also keyed by `triton_key()`, so that a new version of Triton
+    never reuses the results of an old one. `export` and `import_` move the
+    entries of the current version between machines.
+    """
+
+    def __init__(self):
+        self.cache = FileCacheManager("autotune")
+
+    @staticmethod
+    def version() -> str:
+        from ..compiler.compiler import triton_key
+        return hashlib.sha256(triton_key().encode("utf-8")).hexdigest()
+
+    @classmethod
+    def make_key(cls, kernel_key: str, target, tuning_key, configs_hash: str) -> str:
+        key = f"{cls.version()}-{kernel_key}-{target}-{tuning_key}-{configs_hash}"
+        return hashlib.sha256(key.encode("utf-8")).hexdigest()
+
+    def get(self, key: str) -> Optional[Dict]:
+        path = self.cache.get_file(f"{key}.json")
+        if path is None:
+            return None
+        try:
+            with open(path) as f:
+                entry = json.load(f)
+        except (OSError, ValueError):
+            return None
+        return entry if entry.get("version") == self.version() else None
+
+    def put(self, key: str, entry: Dict):
+        self.cache.put(json.dumps(dict(entry, version=self.version())), f"{key}.json", binary=False)
+
+    def export(self, path: str) -> int:
+        """Writes the entries of the current version to `path`. Returns their number."""
+        entries = dict()
+        for filename in os.listdir(self.cache.cache_dir):
+            if filename.endswith(".json"):
+                entry = self.get(filename[:-len(".json")])
+                if entry is not None:
+                    entries[filename[:-len(".json")]] = entry
+        with open(path, "w") as f:
+            json.dump(entries, f)
+        return len(entries)
+
+    def import_(self, path: str) -> int:
+        """Adds the entries of `path` made by the current version. Returns their number."""
+        with open(path) as f:
+            entries = json.load(f)
+        version = self.version()
+        entries = {key: entry for key, entry in entries.items() if entry.get("version") == version}
+        for key, entry in entries.items():
+            self.put(key, entry)
+        return len(entries)
+
+
 def make_so_cache_key(version_hash, signature, constants, ids, **kwargs):
     # Get unique key for the compiled code
     signature = {k: 'ptr' if v[0] == '*' else v for k, v in signature.items()}
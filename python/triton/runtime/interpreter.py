@@ -1,6 +1,9 @@
 import ast
+import os
 import textwrap
 import inspect
+import threading
+from concurrent.futures import ThreadPoolExecutor
 from typing import Tuple, List
 
 import math
@@ -279,6 +282,13 @@ class InterpreterBuilder:
         self.codegen_fns = {}
         self.codegen_fns["convert_custom_types"] = ExtraFunctions._convert_custom_types
         self.codegen_fns["min_dot_size"] = lambda lhsType, rhsType: (1, 1, 1)
+        # Programs of a grid may be executed concurrently by several worker
+        # threads, so the index of the program being executed is per thread.
+        self._program_state = threading.local()
+
+    @property
+    def grid_idx(self):
+        return getattr(self._program_state, "grid_idx", None)
 
     def set_grid_idx(self, x, y, z):
         if not x < self.grid_dim[0]:
@@ -287,7 +297,7 @@ class InterpreterBuilder:
             raise ValueError("y >= grid_dim[1]")
         if not z < self.grid_dim[2]:
             raise ValueError("z >= grid_dim[2]")
-        self.grid_idx = (x, y, z)
+        self._program_state.grid_idx = (x, y, z)
 
     def set_grid_dim(self, nx, ny, nz):
         self.grid_dim = (nx, ny, nz)
@@ -596,6 +606,38 @@ class InterpreterBuilder:
     def create_gather(self, src, indices, axis):
         return TensorHandle(np.take_along_axis(src.data, indices.data, axis=axis), src.dtype.scalar)
 
+    @staticmethod
+    def _sort_keys(src):
+        # numpy compares the elements with the signedness of their dtype, but
+        # bfloat16 and float8 are stored as unsigned integers of their bits:
+        # flip their sign-magnitude encoding into integers of the same order.
+        data = src.data
+        if src.dtype.scalar.is_floating() and data.dtype.kind == 'u':
+            sign_bit = data.dtype.type(1 << (data.dtype.itemsize * 8 - 1))
+            return np.where(data & sign_bit, ~data, data | sign_bit)
+        return data
+
+    @staticmethod
+    def _sorted(src, axis):
+        keys = InterpreterBuilder._sort_keys(src)
+        if keys is src.data:
+            return np.sort(src.data, axis=axis)
+        return np.take_along_axis(src.data, np.argsort(keys, axis=axis, kind='stable'), axis=axis)
+
+    def create_sort(self, src, axis, descending, is_unsigned):
+        data = self._sorted(src, axis)
+        if descending:
+            data = np.flip(data, axis=axis)
+        return TensorHandle(np.ascontiguousarray(data), src.dtype.scalar)
+
+    def create_topk(self, src, k, axis, is_unsigned, return_indices):
+        order = np.flip(np.argsort(self._sort_keys(src), axis=axis, kind='stable'), axis=axis)
+        order = np.take(order, np.arange(k), axis=axis)
+        values = TensorHandle(np.ascontiguousarray(np.take_along_axis(src.data, order, axis=axis)), src.dtype.scalar)
+        if not return_indices:
+            return (values, )
+        return (values, TensorHandle(np.ascontiguousarray(order.astype(np.int32)), tl.int32))
+
     # pointer arithmetic
 
     def create_addptr(self, ptr, offset):
@@ -928,9 +970,11 @@ class ReduceOps(ReduceScanOpInterface):
 
 class ScanOps(ReduceScanOpInterface):
 
-    def __init__(self, axis, combine_fn, reverse):
+    def __init__(self, axis, combine_fn, reverse, exclusive=False, segment_heads=None):
         super().__init__(axis, combine_fn)
         self.reverse = reverse
+        self.exclusive = exclusive
+        self.segment_heads = None if segment_heads is None else segment_heads.handle.data.astype(bool)
 
     def cumsum(self, input):
         return [self.to_tensor(np.cumsum(input.handle.data, axis=self.axis), dtype=input.dtype)]
@@ -938,7 +982,7 @@ class ScanOps(ReduceScanOpInterface):
     def cumprod(self, input):
         return [self.to_tensor(np.cumprod(input.handle.data, axis=self.axis), dtype=input.dtype)]
 
-    def generic_scan(self, input):
+    def generic_scan(self, input, heads=None):
         input_data = []
         output_data = []
         shape = input[0].handle.data.shape
@@ -950,7 +994,7 @@ class ScanOps(ReduceScanOpInterface):
             # Recover index from i using shape
             index = np.unravel_index(i, shape)
             data = tuple(self.to_tensor(d[index], input[ii].dtype) for ii, d in enumerate(input_data))
-            if index[self.axis] == 0:
+            if index[self.axis] == 0 or (heads is not None and heads[index]):
                 # First element
                 for j in range(len(output_data)):
                     output_data[j][index] = data[j].handle.data.item()
@@ -968,20 +1012,53 @@ class ScanOps(ReduceScanOpInterface):
             ret.append(self.to_tensor(data, input[i].dtype))
         return ret
 
+    def check_exclusive(self, input):
+        # The first element of an exclusive scan is zero, which is only the
+        # identity of an addition. The combine function must add its
+        # arguments, as the compiler checks on the combine region.
+        lhs = [self.to_tensor(np.array([1, 3]), arg.dtype) for arg in input]
+        rhs = [self.to_tensor(np.array([2, 5]), arg.dtype) for arg in input]
+        ret = self.combine_fn.fn(*lhs, *rhs)
+        ret = ret if isinstance(ret, tuple) else (ret, )
+        for r, a, b in zip(ret, lhs, rhs):
+            if not np.array_equal(r.handle.data, a.handle.data + b.handle.data):
+                raise ValueError("exclusive scans require a combine_fn that adds its arguments")
+
+    def make_exclusive(self, ret, heads):
+        # Shift the inclusive scan by one element along the axis, the first
+        # element of the scan and of each segment is zero.
+        for arg in ret:
+            data = np.roll(arg.handle.data, 1, axis=self.axis)
+            first = [slice(None)] * data.ndim
+            first[self.axis] = 0
+            data[tuple(first)] = 0
+            if heads is not None:
+                data[heads] = 0
+            arg.handle.data = data
+
     def apply_impl(self, input):
+        if self.exclusive:
+            self.check_exclusive(input)
         new_input = []
+        heads = self.segment_heads
         if self.reverse:
             for arg in input:
                 new_input.append(self.to_tensor(np.flip(arg.handle.data, axis=self.axis), arg.dtype))
+            if heads is not None:
+                heads = np.flip(heads, axis=self.axis)
         else:
             new_input = input
-        if self.combine_fn == tl.standard._sum_combine:
+        if heads is not None:
+            ret = self.generic_scan(new_input, heads)
+        elif self.combine_fn == tl.standard._sum_combine:
             ret = self.cumsum(new_input[0])
         elif self.combine_fn == tl.standard._prod_combine:
             ret = self.cumprod(new_input[0])
         else:
             # Fall back to the slow mode
             ret = self.generic_scan(new_input)
+        if self.exclusive:
+            self.make_exclusive(ret, heads)
         if self.reverse:
             for arg in ret:
                 arg.handle.data = np.flip(arg.handle.data, axis=self.axis)
@@ -995,8 +1072,8 @@ def _patch_reduce_scan():
     def _new_reduce(input, axis, combine_fn, keep_dims=False, **kwargs):
         return ReduceOps(axis, combine_fn, keep_dims).apply(input)
 
-    def _new_scan(input, axis, combine_fn, reverse=False, **kwargs):
-        return ScanOps(axis, combine_fn, reverse).apply(input)
+    def _new_scan(input, axis, combine_fn, reverse=False, exclusive=False, segment_heads=None, **kwargs):
+        return ScanOps(axis, combine_fn, reverse, exclusive, segment_heads).apply(input)
 
     tl.reduce = _new_reduce
     tl.associative_scan = _new_scan
@@ -1145,6 +1222,13 @@ def _rewrap_tensor(t, original_tensor):
     return t
 
 
+def _get_interpreter_num_threads():
+    num_threads = int(os.getenv("TRITON_INTERPRET_NUM_THREADS", "1"))
+    if num_threads <= 0:
+        num_threads = os.cpu_count() or 1
+    return num_threads
+
+
 class GridExecutor:
 
     def __init__(self, fn, arg_names, grid):
@@ -1202,6 +1286,29 @@ class GridExecutor:
             kwarg_hst = kwargs_hst[key]
             _from_cpu(kwarg_dev, kwarg_hst)
 
+    def _run_programs(self, args, grid, start, end):
+        # Programs are linearized with z being the fastest varying dimension,
+        # which matches the order of the serial x/y/z loop nest.
+        for pid in range(start, end):
+            x, rem = divmod(pid, grid[1] * grid[2])
+            y, z = divmod(rem, grid[2])
+            interpreter_builder.set_grid_idx(x, y, z)
+            self.fn(**args)
+
+    def _run_programs_parallel(self, args, grid, num_programs, num_threads):
+        # Each worker runs a contiguous range of programs. The memory and atomic
+        # primitives in libtriton release the GIL, and atomics are performed on
+        # the host memory directly, so programs behave as on a real device where
+        # the order of execution between programs is unspecified.
+        chunk_size = (num_programs + num_threads - 1) // num_threads
+        with ThreadPoolExecutor(max_workers=num_threads, thread_name_prefix="triton-interpreter") as executor:
+            futures = [
+                executor.submit(self._run_programs, args, grid, start, min(start + chunk_size, num_programs))
+                for start in range(0, num_programs, chunk_size)
+            ]
+            for future in futures:
+                future.result()
+
     def __call__(self, *args_dev, **kwargs):
         if kwargs.pop("warmup", False):
             return
@@ -1223,12 +1330,13 @@ class GridExecutor:
         assert len(grid) <= 3, "grid must have at most 3 dimensions"
         grid = grid + (1, ) * (3 - len(grid))
         interpreter_builder.set_grid_dim(*grid)
+        num_programs = grid[0] * grid[1] * grid[2]
+        num_threads = min(_get_interpreter_num_threads(), num_programs)
         try:
-            for x in range(grid[0]):
-                for y in range(grid[1]):
-                    for z in range(grid[2]):
-                        interpreter_builder.set_grid_idx(x, y, z)
-                        self.fn(**args)
+            if num_threads <= 1:
+                self._run_programs(args, grid, 0, num_programs)
+            else:
+                self._run_programs_parallel(args, grid, num_programs, num_threads)
         except Exception as e:
             raise InterpreterError(repr(e)) from e
         # copy arguments back to propagate side-effects
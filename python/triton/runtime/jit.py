@@ -17,6 +17,10 @@ TRITON_MODULE = __name__[:-len(".runtime.jit")]
 
 T = TypeVar("T")
 
+# Environment variables that the backends read in `parse_options`. They select
+# the options of a compilation, so they are part of the key of its kernel.
+OPTIONS_ENV_VARS = ("TRITON_OVERRIDE_ARCH", "TRITON_DEFAULT_FP_FUSION", "TRITON_LIBDEVICE_PATH")
+
 # -----------------------------------------------------------------------------
 # Dependencies Finder
 # -----------------------------------------------------------------------------
@@ -503,12 +507,21 @@ class JITFunction(KernelInterface[T]):
         Precompute as much as possible.
         """
         from ..compiler import CompiledKernel, compile, ASTSource, make_backend
+        from ..backends.compiler import BaseBackend
+        from .._C.libtriton import specialize
         target = driver.active.get_current_target()
         backend = make_backend(target)
         self.CompiledKernel = CompiledKernel
         self.compile = compile
         self.ASTSource = ASTSource
         binder = create_function_from_signature(self.signature, self.params, backend)
+        # The native key only covers the specializations of the base backend.
+        self.key_hasher = None
+        if type(backend).get_arg_specialization is BaseBackend.get_arg_specialization:
+            flags = [(specialize.CONSTEXPR if p.is_constexpr else 0) |
+                     (specialize.NO_SPECIALIZE if p.do_not_specialize else 0) |
+                     (specialize.NO_ALIGN if p.do_not_specialize_on_alignment else 0) for p in self.params]
+            self.key_hasher = specialize.key_hasher(self.arg_names, flags)
         self.constexpr_indices = [i for (i, p) in enumerate(self.params) if p.is_constexpr]
         self.non_constexpr_indices = [i for (i, p) in enumerate(self.params) if not p.is_constexpr]
         self.specialised_indices = [
@@ -516,6 +529,85 @@ class JITFunction(KernelInterface[T]):
         ]
         return {}, target, backend, binder
 
+    def _specialize(self, backend, bound_args, specialization, kwargs):
+        # options
+        options = backend.parse_options(kwargs)
+        # signature
+        sigkeys = [x.name for x in self.params]
+        sigvals = [x[0] for x in specialization]
+        signature = {k: v for (k, v) in zip(sigkeys, sigvals)}
+        # check arguments
+        assert "device_type" not in kwargs, "device_type option is deprecated; current target will be used"
+        assert "device" not in kwargs, "device option is deprecated; current device will be used"
+        assert "stream" not in kwargs, "stream option is deprecated; current stream will be used"
+        for k in kwargs:
+            if k not in options.__dict__ and k not in sigkeys:
+                raise KeyError("Keyword argument %s was specified but unrecognised" % k)
+        # constexprs
+        constexprs = find_paths_if(sigvals, lambda _, val: val == "constexpr")
+        constexprs = {path: get_iterable_path(list(bound_args.values()), path) for path in constexprs}
+        # attributes
+        attrvals = [x[1] for x in specialization]
+        attrs = find_paths_if(attrvals, lambda _, x: isinstance(x, str))
+        attrs = {k: backend.parse_attr(get_iterable_path(attrvals, k)) for k in attrs}
+        return options, signature, constexprs, attrs
+
+    def estimate_resources(self, *args, **kwargs):
+        """
+        Returns static estimates of the resources used by the kernel
+        specialized for `args` and `kwargs`, without lowering it to LLVM or
+        launching it. See `triton.compiler.estimate_resources`.
+        """
+        from ..compiler import estimate_resources
+        kwargs["debug"] = kwargs.get("debug", self.debug) or os.environ.get("TRITON_DEBUG", "0") == "1"
+        _, target, backend, binder = self.device_caches[driver.active.get_current_device()]
+        bound_args, specialization, _ = binder(*args, **kwargs)
+        options, signature, constexprs, attrs = self._specialize(backend, bound_args, specialization, kwargs)
+        src = self.ASTSource(self, signature, constexprs, attrs)
+        return estimate_resources(src, target=target, options=options.__dict__)
+
+    def _check_used_global_vals(self):
+        # Check that used global values have not changed.
+        not_present = object()
+        for (name, _), (val, globals_dict) in self.used_global_vals.items():
+            if (newVal := globals_dict.get(name, not_present)) != val:
+                raise RuntimeError(
+                    f"Global variable {name} has changed since we compiled this kernel, from {val} to {newVal}")
+
+    def _make_launcher(self, kernel, num_args):
+        """
+        Returns a function that launches `kernel` for calls with `num_args`
+        positional arguments, i.e. `launch(grid, stream, args, kwargs)`, as the
+        end of `run` does, with the lookups that do not depend on the
+        arguments done once.
+        """
+        tail = [(p.name, p.default) for p in self.params[num_args:]]
+        arg_names = self.arg_names
+        CompiledKernel = self.CompiledKernel
+        # The handles of the kernel are loaded by its first launch.
+        handles = []
+
+        def launch(grid, stream, args, kwargs):
+            if tail:
+                args = args + tuple([kwargs.get(name, default) for name, default in tail])
+            if not handles:
+                handles.extend((kernel.run, kernel.function, kernel.packed_metadata))
+            run, function, packed_metadata = handles
+            # canonicalize grid
+            assert grid is not None
+            if callable(grid):
+                grid = grid(dict(zip(arg_names, args)))
+            grid_size = len(grid)
+            grid_0 = grid[0]
+            grid_1 = grid[1] if grid_size > 1 else 1
+            grid_2 = grid[2] if grid_size > 2 else 1
+            launch_enter_hook = CompiledKernel.launch_enter_hook
+            launch_metadata = kernel.launch_metadata(grid, stream, *args) if launch_enter_hook is not None else None
+            run(grid_0, grid_1, grid_2, stream, function, packed_metadata, launch_metadata, launch_enter_hook,
+                CompiledKernel.launch_exit_hook, *args)
+
+        return launch
+
     def run(self, *args, grid, warmup, **kwargs):
         kwargs["debug"] = kwargs.get("debug", self.debug) or os.environ.get("TRITON_DEBUG", "0") == "1"
 
@@ -528,34 +620,33 @@ class JITFunction(KernelInterface[T]):
             hook(*args, **kwargs)
 
         kernel_cache, target, backend, binder = self.device_caches[device]
+        env = tuple([os.environ.get(name) for name in OPTIONS_ENV_VARS])
+        # Fast path: a native hash of the arguments finds the kernel, and the
+        # launcher, of a previous call with the same specialization. The hash
+        # is 64 bits wide and a hit does not rebuild the full key to confirm
+        # it: two specializations of a function collide with a probability of
+        # about 2**-64 per pair, which is accepted for the cost of the check.
+        fast_key = self.key_hasher(args, kwargs) if self.key_hasher is not None else None
+        if fast_key is not None:
+            fast_key = (fast_key, env)
+            entry = self.fast_caches[device].get(fast_key)
+            # The kernel cache stays the reference: clearing it also
+            # invalidates the fast path.
+            if entry is not None and kernel_cache.get(entry[0]) is entry[1]:
+                self._check_used_global_vals()
+                if not warmup:
+                    entry[2](grid, stream, args, kwargs)
+                return entry[1]
+
         bound_args, specialization, options = binder(*args, **kwargs)
 
         # compute cache key
-        key = str(specialization) + str(options)
+        key = str(specialization) + str(options) + str(env)
         kernel = kernel_cache.get(key, None)
 
         # Kernel is not cached; we have to compile.
         if kernel is None:
-            # options
-            options = backend.parse_options(kwargs)
-            # signature
-            sigkeys = [x.name for x in self.params]
-            sigvals = [x[0] for x in specialization]
-            signature = {k: v for (k, v) in zip(sigkeys, sigvals)}
-            # check arguments
-            assert "device_type" not in kwargs, "device_type option is deprecated; current target will be used"
-            assert "device" not in kwargs, "device option is deprecated; current device will be used"
-            assert "stream" not in kwargs, "stream option is deprecated; current stream will be used"
-            for k in kwargs:
-                if k not in options.__dict__ and k not in sigkeys:
-                    raise KeyError("Keyword argument %s was specified but unrecognised" % k)
-            # constexprs
-            constexprs = find_paths_if(sigvals, lambda _, val: val == "constexpr")
-            constexprs = {path: get_iterable_path(list(bound_args.values()), path) for path in constexprs}
-            # attributes
-            attrvals = [x[1] for x in specialization]
-            attrs = find_paths_if(attrvals, lambda _, x: isinstance(x, str))
-            attrs = {k: backend.parse_attr(get_iterable_path(attrvals, k)) for k in attrs}
+            options, signature, constexprs, attrs = self._specialize(backend, bound_args, specialization, kwargs)
             if self._call_hook(key, signature, device, constexprs, options, [attrs], warmup, before=True):
                 return None
             # compile the kernel
@@ -563,13 +654,10 @@ class JITFunction(KernelInterface[T]):
             kernel = self.compile(src, target=target, options=options.__dict__)
             kernel_cache[key] = kernel
             self._call_hook(key, signature, device, constexprs, options, [attrs], warmup, before=False)
+        if fast_key is not None:
+            self.fast_caches[device][fast_key] = (key, kernel, self._make_launcher(kernel, len(args)))
 
-        # Check that used global values have not changed.
-        not_present = object()
-        for (name, _), (val, globals_dict) in self.used_global_vals.items():
-            if (newVal := globals_dict.get(name, not_present)) != val:
-                raise RuntimeError(
-                    f"Global variable {name} has changed since we compiled this kernel, from {val} to {newVal}")
+        self._check_used_global_vals()
 
         if not warmup:
             # canonicalize grid
@@ -614,6 +702,10 @@ class JITFunction(KernelInterface[T]):
         self._unsafe_update_src(src)
         # cache of just-in-time compiled kernels
         self.device_caches = defaultdict(lambda: self.create_binder())
+        # Kernels of the device caches by the native key of their arguments
+        # and the values of OPTIONS_ENV_VARS, with their launchers (see `run`).
+        self.fast_caches = defaultdict(dict)
+        self.key_hasher = None
         self.hash = None
 
         # Map of global variables used by the function and any functions it
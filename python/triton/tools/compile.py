@@ -4,7 +4,7 @@ import importlib.util
 import sys
 from argparse import ArgumentParser
 from pathlib import Path
-from typing import List
+from typing import Dict, List, Tuple
 
 import triton
 import triton.backends
@@ -36,82 +36,75 @@ NOTE: when resolving the scope of /path/to/kernel.py, the file will be executed
 used to run this `compile.py` script
 """
 
-if __name__ == "__main__":
-
-    # command-line arguments
-    parser = ArgumentParser(description=desc)
-    parser.add_argument("path",
-                        help="Path to Python source containing desired kernel in its scope. File will be executed.")
-    parser.add_argument("--kernel-name", "-n", type=str, default="", help="Name of the kernel to compile",
-                        required=True)
-    parser.add_argument("--num-warps", "-w", type=int, default=1, help="Number of warps to launch the kernel")
-    parser.add_argument("--num-stages", "-ns", type=int, default=3,
-                        help="Number of stages (meta-parameter of the kernel)")
-    parser.add_argument("--out-name", "-on", type=str, default=None, help="Out name for the compiled kernel")
-    parser.add_argument("--out-path", "-o", type=Path, default=None, help="Out filename")
-    parser.add_argument("--signature", "-s", type=str, help="Signature of the kernel", required=True)
-    parser.add_argument("--grid", "-g", type=str, help="Launch grid of the kernel", required=True)
-    args = parser.parse_args()
-
-    out_name = args.out_name if args.out_name else args.kernel_name
-    out_path = args.out_path if args.out_path else Path(out_name)
-
-    # execute python sources and extract functions wrapped in JITFunction
-    arg_path = Path(args.path)
-    sys.path.insert(0, str(arg_path.parent))
-    spec = importlib.util.spec_from_file_location(arg_path.stem, arg_path)
+def load_kernel(path: Path, kernel_name: str):
+    """Executes the Python source at `path` and returns its JITFunction named `kernel_name`."""
+    sys.path.insert(0, str(path.parent))
+    spec = importlib.util.spec_from_file_location(path.stem, path)
     mod = importlib.util.module_from_spec(spec)
     spec.loader.exec_module(mod)
-    kernel = getattr(mod, args.kernel_name)
-    grid = args.grid.split(",")
-    assert len(grid) == 3
-
-    # validate and parse signature
-    signature = list(map(lambda s: s.strip(" "), args.signature.split(",")))
-
-    def hash_signature(signature: List[str]):
-        m = hashlib.sha256()
-        m.update(" ".join(signature).encode())
-        return m.hexdigest()[:8]
-
-    meta_sig = f"warps{args.num_warps}xstages{args.num_stages}"
-    sig_hash = hash_signature(signature + [meta_sig])
-
-    def constexpr(s):
-        try:
-            ret = int(s)
-            return ret
-        except ValueError:
-            pass
-        try:
-            ret = float(s)
-            return ret
-        except ValueError:
-            pass
-        return None
-
-    hints = {(i, ): constexpr(s.split(":")[1]) for i, s in enumerate(signature) if ":" in s}
+    return getattr(mod, kernel_name)
+
+
+def constexpr(s):
+    try:
+        ret = int(s)
+        return ret
+    except ValueError:
+        pass
+    try:
+        ret = float(s)
+        return ret
+    except ValueError:
+        pass
+    return None
+
+
+def hash_signature(signature: List[str]):
+    m = hashlib.sha256()
+    m.update(" ".join(signature).encode())
+    return m.hexdigest()[:8]
+
+
+def parse_signature(kernel, signature: str) -> Tuple[List[str], Dict[str, str], Dict[str, object], Dict[tuple, int]]:
+    """
+    Parses a signature in the format described above. Returns its stripped
+    entries, the type of each argument ('constexpr' for constants), the value
+    of each constant and the divisibility hint of each hinted argument.
+    """
+    entries = list(map(lambda s: s.strip(" "), signature.split(",")))
+    hints = {(i, ): constexpr(s.split(":")[1]) for i, s in enumerate(entries) if ":" in s}
     hints = {k: v for k, v in hints.items() if v is not None}
-    constants = {kernel.arg_names[i]: constexpr(s) for i, s in enumerate(signature)}
+    constants = {kernel.arg_names[i]: constexpr(s) for i, s in enumerate(entries)}
     constants = {k: v for k, v in constants.items() if v is not None}
     for key, value in hints.items():
         if value == 1:
             constants[kernel.arg_names[key[0]]] = value
-    signature = {kernel.arg_names[i]: s.split(":")[0] for i, s in enumerate(signature)}
+    types = {kernel.arg_names[i]: s.split(":")[0] for i, s in enumerate(entries)}
     for key in constants:
-        signature[key] = 'constexpr'
-    const_sig = 'x'.join([str(v) for v in constants.values()])
-    doc_string = [f"{k}={v}" for k, v in constants.items()]
-    doc_string += [f"num_warps={args.num_warps}", f"num_stages={args.num_stages}"]
-    # compile ast into cubin
+        types[key] = 'constexpr'
     for h in hints.values():
         assert h in [1, 16], f"Only 1 and 16 are valid hints, got {h}"
+    return entries, types, constants, hints
+
+
+def make_ast_source(kernel, signature: str):
+    """Returns the ASTSource of `kernel` specialized for `signature`."""
+    _, types, constants, hints = parse_signature(kernel, signature)
     attrs = {k: [["tt.divisibility", 16]] for k, v in hints.items() if v == 16}
-    src = triton.compiler.ASTSource(fn=kernel, constexprs=constants, signature=signature, attrs=attrs)
-    opts = {"num_warps": args.num_warps, "num_stages": args.num_stages}
-    ccinfo = triton.compile(src, options=opts)
+    return triton.compiler.ASTSource(fn=kernel, constexprs=constants, signature=types, attrs=attrs)
+
+
+def write_c_stubs(ccinfo, kernel, kernel_name: str, signature: str, num_warps: int, num_stages: int, grid: List[str],
+                  out_name: str, out_path: Path):
+    """Writes the C header and source that embed the cubin of `ccinfo` and launch it."""
     if ccinfo.metadata.global_scratch_size > 0:
         raise RuntimeError("AOT compiling kernels with global scratch requirements is not yet implemented")
+    entries, signature, constants, hints = parse_signature(kernel, signature)
+    meta_sig = f"warps{num_warps}xstages{num_stages}"
+    sig_hash = hash_signature(entries + [meta_sig])
+    const_sig = 'x'.join([str(v) for v in constants.values()])
+    doc_string = [f"{k}={v}" for k, v in constants.items()]
+    doc_string += [f"num_warps={num_warps}", f"num_stages={num_stages}"]
 
     arg_names = []
     arg_types = []
@@ -140,7 +133,7 @@ if __name__ == "__main__":
     hex_ = str(binascii.hexlify(asm))[2:-1]
     params = {
         "kernel_name": func_name,
-        "triton_kernel_name": args.kernel_name,
+        "triton_kernel_name": kernel_name,
         "bin_size": len(asm),
         "bin_data": ", ".join([f"0x{x}{y}" for x, y in zip(hex_[::2], hex_[1::2])]),
         "signature": ", ".join([f"{ty_to_cpp(ty)} {name}" for name, ty in zip(arg_names_not_1, arg_types_not_1)]),
@@ -149,7 +142,7 @@ if __name__ == "__main__":
         "num_args": len(arg_names_not_1) + 1,
         "kernel_docstring": doc_string,
         "shared": ccinfo.metadata.shared,
-        "num_warps": args.num_warps,
+        "num_warps": num_warps,
         "algo_info": '_'.join([const_sig, meta_sig]),
         "gridX": grid[0],
         "gridY": grid[1],
@@ -160,3 +153,36 @@ if __name__ == "__main__":
         template_path = Path(__file__).parent / "extra" / "cuda" / f"compile.{ext}"
         with out_path.with_suffix(f".{sig_hash}_{suffix}.{ext}").open("w") as fp:
             fp.write(Path(template_path).read_text().format(**params))
+
+
+if __name__ == "__main__":
+
+    # command-line arguments
+    parser = ArgumentParser(description=desc)
+    parser.add_argument("path",
+                        help="Path to Python source containing desired kernel in its scope. File will be executed.")
+    parser.add_argument("--kernel-name", "-n", type=str, default="", help="Name of the kernel to compile",
+                        required=True)
+    parser.add_argument("--num-warps", "-w", type=int, default=1, help="Number of warps to launch the kernel")
+    parser.add_argument("--num-stages", "-ns", type=int, default=3,
+                        help="Number of stages (meta-parameter of the kernel)")
+    parser.add_argument("--out-name", "-on", type=str, default=None, help="Out name for the compiled kernel")
+    parser.add_argument("--out-path", "-o", type=Path, default=None, help="Out filename")
+    parser.add_argument("--signature", "-s", type=str, help="Signature of the kernel", required=True)
+    parser.add_argument("--grid", "-g", type=str, help="Launch grid of the kernel", required=True)
+    args = parser.parse_args()
+
+    out_name = args.out_name if args.out_name else args.kernel_name
+    out_path = args.out_path if args.out_path else Path(out_name)
+
+    # execute python sources and extract functions wrapped in JITFunction
+    kernel = load_kernel(Path(args.path), args.kernel_name)
+    grid = args.grid.split(",")
+    assert len(grid) == 3
+
+    # compile ast into cubin
+    src = make_ast_source(kernel, args.signature)
+    opts = {"num_warps": args.num_warps, "num_stages": args.num_stages}
+    ccinfo = triton.compile(src, options=opts)
+    write_c_stubs(ccinfo, kernel, args.kernel_name, args.signature, args.num_warps, args.num_stages, grid, out_name,
+                  out_path)
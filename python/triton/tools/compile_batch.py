@@ -0,0 +1,119 @@
+import hashlib
+import json
+import os
+import sys
+import time
+from argparse import ArgumentParser
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from pathlib import Path
+
+import triton
+from triton.backends.compiler import GPUTarget
+from triton.compiler.compiler import make_backend
+from triton.runtime.driver import driver
+from triton.tools.compile import load_kernel, make_ast_source, write_c_stubs
+
+desc = """
+Triton ahead-of-time batch compiler:
+
+This program compiles every kernel listed in a JSON manifest, concurrently,
+into the Triton cache, so that later calls of the same specializations (from
+`compile.py` or from the JIT) are cache hits. Entries that also provide a
+`grid` are written out as C sources, exactly as `compile.py` would.
+
+The manifest is a list of entries such as
+
+  {"path": "/path/to/kernel.py", "kernel_name": "kernel",
+   "signature": "*fp32:16, i32:16, 1024, i32", "num_warps": 4, "num_stages": 3,
+   "grid": "1024, 1, 1", "out_name": "kernel"}
+
+where `path`, `kernel_name` and `signature` follow the arguments of `compile.py`,
+and any other option of the backend (e.g. "num_ctas") can be given in an
+"options" dictionary.
+
+All entries are compiled in this process, so the Python sources, the MLIR
+dialects and the LLVM targets are only loaded once. Entries that resolve to the
+same cache key are compiled once.
+
+`compile_batch.py manifest.json --jobs 16 --target cuda:90 --out-dir out/`
+"""
+
+
+def parse_target(target):
+    """Parses a `backend:arch[:warp_size]` target such as `cuda:90` or `hip:gfx942:64`."""
+    backend, arch, *warp_size = target.split(":")
+    arch = int(arch) if arch.isdigit() else arch
+    return GPUTarget(backend, arch, int(warp_size[0]) if warp_size else 32)
+
+
+def compile_batch(entries, target, jobs, out_dir=None):
+    """
+    Compiles the manifest `entries` for `target` with `jobs` threads. Returns
+    the number of distinct compilations and a list of (entry, exception) for
+    the entries that failed.
+    """
+    backend = make_backend(target)
+    kernels = dict()
+    groups = dict()
+    for entry in entries:
+        path = Path(entry["path"]).resolve()
+        name = entry["kernel_name"]
+        if (path, name) not in kernels:
+            kernels[(path, name)] = load_kernel(path, name)
+        kernel = kernels[(path, name)]
+        src = make_ast_source(kernel, entry["signature"])
+        opts = dict(entry.get("options", dict()))
+        opts["num_warps"] = entry.get("num_warps", 1)
+        opts["num_stages"] = entry.get("num_stages", 3)
+        # Identical specializations (e.g. autotuning configs that only differ
+        # in launch parameters) would race to write the same cache entry.
+        options = backend.parse_options(dict(opts, **src.parse_options()))
+        key = hashlib.sha256(f"{src.hash()}-{options.hash()}".encode("utf-8")).hexdigest()
+        if key not in groups:
+            groups[key] = (src, opts, [])
+        groups[key][2].append((kernel, entry))
+
+    def compile_group(src, opts, members):
+        ccinfo = triton.compile(src, target=target, options=opts)
+        if out_dir is not None:
+            for kernel, entry in members:
+                if "grid" not in entry:
+                    continue
+                grid = entry["grid"].split(",")
+                assert len(grid) == 3
+                out_name = entry.get("out_name", entry["kernel_name"])
+                write_c_stubs(ccinfo, kernel, entry["kernel_name"], entry["signature"], opts["num_warps"],
+                              opts["num_stages"], grid, out_name, out_dir / out_name)
+
+    failures = []
+    with ThreadPoolExecutor(max_workers=jobs) as executor:
+        futures = {executor.submit(compile_group, *group): group for group in groups.values()}
+        for future in as_completed(futures):
+            exception = future.exception()
+            if exception is not None:
+                failures += [(entry, exception) for _, entry in futures[future][2]]
+    return len(groups), failures
+
+
+if __name__ == "__main__":
+    parser = ArgumentParser(description=desc)
+    parser.add_argument("manifest", type=Path, help="Path to the JSON manifest of kernels to compile")
+    parser.add_argument("--jobs", "-j", type=int, default=os.cpu_count(), help="Number of concurrent compilations")
+    parser.add_argument("--target", "-t", type=str, default=None,
+                        help="Target to compile for, e.g. cuda:90 (default: the active device)")
+    parser.add_argument("--out-dir", "-o", type=Path, default=None,
+                        help="Directory for the C sources of the entries with a grid")
+    args = parser.parse_args()
+
+    entries = json.loads(args.manifest.read_text())
+    target = parse_target(args.target) if args.target else driver.active.get_current_target()
+    if args.out_dir is not None:
+        args.out_dir.mkdir(parents=True, exist_ok=True)
+
+    start = time.perf_counter()
+    num_compiled, failures = compile_batch(entries, target, args.jobs, args.out_dir)
+    elapsed = time.perf_counter() - start
+    for entry, exception in failures:
+        print(f"failed to compile {entry['kernel_name']} ({entry['signature']}): {exception}", file=sys.stderr)
+    print(f"compiled {len(entries)} entries ({num_compiled} distinct) in {elapsed:.1f}s, {len(failures)} failed")
+    sys.exit(1 if failures else 0)
@@ -1,5 +1,6 @@
 // RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-allocation 2>&1 | FileCheck %s --dump-input-context=10
 // RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-allocation="get-scratch-size-function=ValidConstant" 2>&1 | FileCheck %s --check-prefix=CHECK-128
+// RUN: env TRITON_SMEM_SEARCH_STEPS=100 triton-opt %s -split-input-file --mlir-disable-threading -test-print-allocation 2>&1 | FileCheck %s --check-prefix=SEARCH
 
 // Check there are no lines with a size different to 128 and we have at least a line with size 128.
 
@@ -191,6 +192,7 @@ tt.func @longlive(%A : !tt.ptr<f16>) {
 
 // This example triggers graph coloring with > 1 colors.
 // CHECK-LABEL: multi_color
+// SEARCH-LABEL: multi_color
 tt.func @multi_color(%A : !tt.ptr<f16>) {
   // CHECK: offset = 1152, size = 64
   %cst = ttg.local_alloc : () -> !ttg.memdesc<4x8xf16, #A_SHARED, #ttg.shared_memory, mutable>
@@ -233,6 +235,9 @@ tt.func @multi_color(%A : !tt.ptr<f16>) {
   %cst_12 = arith.constant dense<0.000000e+00> : tensor<4x16xf16, #AL>
   %cst_13 = arith.constant dense<0.000000e+00> : tensor<8x32xf16, #AL>
   // CHECK-NEXT: size = 1504
+  // The search reaches the peak number of live bytes, during the first
+  // convert_layout.
+  // SEARCH: size = 1376
   tt.return
 }
 
@@ -14,4 +14,12 @@ tt.func @gather_op(%arg0: tensor<1024x256xi32, #blocked>, %arg1: tensor<128x256x
   tt.return
 }
 
+// CHECK-LABEL: @sort_op
+// The stages across warps go through shared memory.
+tt.func @sort_op(%arg0: tensor<128x256xf32, #blocked>) {
+  // CHECK-NEXT: allocation.offset = 0 : i32
+  %0 = tt.sort %arg0 {axis = 1 : i32, descending = false} : tensor<128x256xf32, #blocked>
+  tt.return
+}
+
 }
@@ -0,0 +1,26 @@
+// RUN: triton-opt %s -split-input-file -convert-triton-to-tritongpu='target=cuda:90 num-warps=4 num-ctas=2' | FileCheck %s
+
+// The lowering of tt.sort and tt.topk keeps the sorted axis within a CTA: a
+// source split along the axis is first replicated across the CTAs.
+
+// CHECK: #[[SORT:[a-z0-9]+]] = #ttg.blocked<{{.*}}CTAsPerCGA = [2], CTASplitNum = [1]
+// CHECK-LABEL: @sort_split_axis
+tt.func @sort_split_axis(%arg0: tensor<1024xf32>, %arg1: tensor<1024xi32>) {
+  // CHECK: %[[SRC:.*]] = ttg.convert_layout %arg0 : tensor<1024xf32, #{{.*}}> -> tensor<1024xf32, #[[SORT]]>
+  // CHECK: tt.sort %[[SRC]] {{.*}} : tensor<1024xf32, #[[SORT]]>
+  %0 = tt.sort %arg0 {axis = 0 : i32, descending = false} : tensor<1024xf32>
+  // CHECK: %[[SRC1:.*]] = ttg.convert_layout %arg1 : tensor<1024xi32, #{{.*}}> -> tensor<1024xi32, #[[SORT]]>
+  // CHECK: tt.topk %[[SRC1]] {{.*}} : tensor<1024xi32, #[[SORT]]> -> tensor<8xi32, #[[SORT]]>
+  %1 = tt.topk %arg1 {axis = 0 : i32, k = 8 : i32} : tensor<1024xi32> -> tensor<8xi32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @sort_split_outer
+tt.func @sort_split_outer(%arg0: tensor<64x128xf32>) {
+  // CHECK-NOT: ttg.convert_layout
+  // CHECK: tt.sort %arg0
+  %0 = tt.sort %arg0 {axis = 1 : i32, descending = false} : tensor<64x128xf32>
+  tt.return
+}
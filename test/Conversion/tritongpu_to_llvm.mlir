@@ -1725,6 +1725,129 @@ module attributes {"ttg.target" = "cuda:80", "ttg.num-ctas" = 1 : i32, "ttg.num-
   }
 }
 
+// -----
+
+// With 8 warps along the axis, the partial results of the warps are combined
+// straight from shared memory, behind a single barrier.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 8], order = [1, 0]}>
+module attributes {"ttg.target" = "cuda:80", "ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 8 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: sum_reduction_single_barrier
+  //       CHECK:   nvvm.redux.sync  add
+  //       CHECK:   st.shared
+  //       CHECK:   nvvm.barrier0
+  //   CHECK-NOT:   nvvm.shfl.sync
+  // CHECK-COUNT-8:   llvm.load {{.*}} : !llvm.ptr<3> -> i32
+  //   CHECK-NOT:   nvvm.barrier0
+  //       CHECK:   llvm.return
+  tt.func public @sum_reduction_single_barrier(%arg0: tensor<1x1024xi32, #blocked>) {
+    %0 = "tt.reduce"(%arg0) <{axis = 1 : i32}> ({
+    ^bb0(%arg1: i32, %arg2: i32):
+      %1 = arith.addi %arg1, %arg2 : i32
+      tt.reduce.return %1 : i32
+    }) : (tensor<1x1024xi32, #blocked>) -> tensor<1xi32, #ttg.slice<{dim = 1, parent = #blocked}>>
+    tt.return
+  }
+}
+
+// -----
+
+// Both operands of an argmax go through the same round of shared memory.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 8], order = [1, 0]}>
+module attributes {"ttg.target" = "cuda:80", "ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 8 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: argmax_single_barrier
+  //       CHECK:   nvvm.barrier0
+  //   CHECK-NOT:   nvvm.shfl.sync
+  // CHECK-COUNT-8:   llvm.load {{.*}} : !llvm.ptr<3> -> f32
+  //   CHECK-NOT:   nvvm.barrier0
+  //       CHECK:   llvm.return
+  tt.func public @argmax_single_barrier(%arg0: tensor<1x1024xf32, #blocked>, %arg1: tensor<1x1024xi32, #blocked>) {
+    %0:2 = "tt.reduce"(%arg0, %arg1) <{axis = 1 : i32}> ({
+    ^bb0(%arg2: f32, %arg3: i32, %arg4: f32, %arg5: i32):
+      %1 = arith.cmpf ogt, %arg2, %arg4 : f32
+      %2 = arith.cmpf oeq, %arg2, %arg4 : f32
+      %3 = arith.cmpi slt, %arg3, %arg5 : i32
+      %4 = arith.andi %2, %3 : i1
+      %5 = arith.ori %1, %4 : i1
+      %6 = arith.select %5, %arg2, %arg4 : f32
+      %7 = arith.select %5, %arg3, %arg5 : i32
+      tt.reduce.return %6, %7 : f32, i32
+    }) : (tensor<1x1024xf32, #blocked>, tensor<1x1024xi32, #blocked>) -> (tensor<1xf32, #ttg.slice<{dim = 1, parent = #blocked}>>, tensor<1xi32, #ttg.slice<{dim = 1, parent = #blocked}>>)
+    tt.return
+  }
+}
+
+// -----
+
+// A sort along an axis held by a warp only needs selects and shuffles.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"ttg.target" = "cuda:80", "ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: sort_warp_local
+  //       CHECK:   nvvm.shfl.sync bfly
+  //   CHECK-NOT:   nvvm.barrier0
+  //       CHECK:   llvm.return
+  tt.func public @sort_warp_local(%arg0: tensor<4x128xf32, #blocked>) {
+    %0 = tt.sort %arg0 {axis = 1 : i32, descending = false} : tensor<4x128xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// The stages that compare elements of different warps, and the extraction of
+// the top-k, go through shared memory.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 2], order = [1, 0]}>
+module attributes {"ttg.target" = "cuda:80", "ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 2 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: topk_across_warps
+  //       CHECK:   nvvm.shfl.sync bfly
+  //       CHECK:   nvvm.barrier0
+  //       CHECK:   llvm.icmp "sgt"
+  //       CHECK:   nvvm.barrier0
+  //       CHECK:   llvm.load {{.*}} : !llvm.ptr<3> -> i32
+  //       CHECK:   llvm.return
+  tt.func public @topk_across_warps(%arg0: tensor<1x256xi32, #blocked>) {
+    %0 = tt.topk %arg0 {axis = 1 : i32, k = 8 : i32} : tensor<1x256xi32, #blocked> -> tensor<1x8xi32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// The positions of a top-k with indices are shuffled and swapped along with
+// the values, and extracted after them.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 2], order = [1, 0]}>
+module attributes {"ttg.target" = "cuda:80", "ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 2 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: topk_indices
+  //       CHECK:   nvvm.shfl.sync bfly
+  //       CHECK:   nvvm.shfl.sync bfly
+  //       CHECK:   llvm.fcmp "ogt"
+  //       CHECK:   llvm.load {{.*}} : !llvm.ptr<3> -> f32
+  //       CHECK:   nvvm.barrier0
+  //       CHECK:   llvm.load {{.*}} : !llvm.ptr<3> -> i32
+  //       CHECK:   llvm.return
+  tt.func public @topk_indices(%arg0: tensor<1x256xf32, #blocked>) {
+    %0:2 = tt.topk %arg0 {axis = 1 : i32, k = 8 : i32} : tensor<1x256xf32, #blocked> -> tensor<1x8xf32, #blocked>, tensor<1x8xi32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// fp8 values are held in i8: compare their sign-magnitude bits as ordered
+// integers.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"ttg.target" = "cuda:90", "ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: sort_fp8
+  //       CHECK:   llvm.ashr {{.*}} : i8
+  //       CHECK:   llvm.lshr {{.*}} : i8
+  //       CHECK:   llvm.xor {{.*}} : i8
+  //       CHECK:   llvm.icmp "sgt" {{.*}} : i8
+  //       CHECK:   llvm.return
+  tt.func public @sort_fp8(%arg0: tensor<4x128xf8E5M2, #blocked>) {
+    %0 = tt.sort %arg0 {axis = 1 : i32, descending = false} : tensor<4x128xf8E5M2, #blocked>
+    tt.return
+  }
+}
+
 // -----
 #blocked = #ttg.blocked<{sizePerThread = [8, 1], threadsPerWarp = [32, 1], warpsPerCTA = [1, 2], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #slice = #ttg.slice<{dim = 1, parent = #blocked}>
@@ -2105,6 +2228,47 @@ module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.targ
 
 // -----
 
+// The segment heads of a warp are gathered with a single ballot, only the
+// values are shuffled.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: segmented_scan_ballot
+  //       CHECK:   nvvm.vote
+  // CHECK-COUNT-5:   nvvm.shfl.sync up
+  //   CHECK-NOT:   nvvm.vote
+  //   CHECK-NOT:   nvvm.barrier0
+  //       CHECK:   llvm.return
+  tt.func public @segmented_scan_ballot(%arg0: tensor<4x128xf32, #blocked>, %arg1: tensor<4x128xi1, #blocked>) {
+    %0:2 = "tt.scan"(%arg0, %arg1) <{axis = 1 : i32, reverse = false, segmented}> ({
+    ^bb0(%arg2: f32, %arg3: f32):
+      %1 = arith.addf %arg2, %arg3 : f32
+      tt.scan.return %1 : f32
+    }) : (tensor<4x128xf32, #blocked>, tensor<4x128xi1, #blocked>) -> (tensor<4x128xf32, #blocked>, tensor<4x128xi1, #blocked>)
+    tt.return
+  }
+}
+
+// -----
+
+// An exclusive scan across warps starts the first thread from zero.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 2], order = [1, 0]}>
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 2 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: exclusive_scan_across_warps
+  //       CHECK:   nvvm.barrier0
+  //       CHECK:   llvm.mlir.zero : i32
+  //       CHECK:   llvm.return
+  tt.func public @exclusive_scan_across_warps(%arg0: tensor<1x256xi32, #blocked>) {
+    %0 = "tt.scan"(%arg0) <{axis = 1 : i32, reverse = false, exclusive}> ({
+    ^bb0(%arg1: i32, %arg2: i32):
+      %1 = arith.addi %arg1, %arg2 : i32
+      tt.scan.return %1 : i32
+    }) : (tensor<1x256xi32, #blocked>) -> tensor<1x256xi32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
 // CHECK: inline_asm_pack
 #blocked = #ttg.blocked<{sizePerThread = [16, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [0, 1]}>
 module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
@@ -145,6 +145,42 @@ tt.func public @fn(%v1: tensor<4x128xf32>, %v2: tensor<4x128xi64>) {
 
 // -----
 
+tt.func public @fn(%v: tensor<4x128xf32>, %heads: tensor<4x128xi32>) {
+    // expected-error @+1 {{segment head flags must be of type i1}}
+    %a, %b = "tt.scan" (%v, %heads) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.scan.return %add : f32
+    }) {axis = 0 : i32, reverse = false, segmented}  : (tensor<4x128xf32>, tensor<4x128xi32>) -> (tensor<4x128xf32>, tensor<4x128xi32>)
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%v: tensor<4x128xf32>, %heads: tensor<4x128xi1>) {
+    // expected-error @+1 {{nested block must take 2 arguments}}
+    %a, %b = "tt.scan" (%v, %heads) ({
+    ^bb0(%arg0: f32, %arg1: i1, %arg2: f32, %arg3: i1):
+      %add = arith.addf %arg0, %arg2 : f32
+      tt.scan.return %add, %arg3 : f32, i1
+    }) {axis = 0 : i32, reverse = false, segmented}  : (tensor<4x128xf32>, tensor<4x128xi1>) -> (tensor<4x128xf32>, tensor<4x128xi1>)
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%v: tensor<4x128xf32>) {
+    // expected-error @+1 {{exclusive scan requires a combine region that adds its arguments}}
+    %a = "tt.scan" (%v) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %max = arith.maxnumf %arg0, %arg1 : f32
+      tt.scan.return %max : f32
+    }) {axis = 0 : i32, reverse = false, exclusive}  : (tensor<4x128xf32>) -> tensor<4x128xf32>
+    tt.return
+}
+
+// -----
+
 tt.func public @fn(%v1: tensor<4x128xf32>, %v2: tensor<4x128xi64>) {
     // expected-error @+1 {{operand types and result types}}
     %a, %b = "tt.reduce" (%v1, %v2) ({
@@ -407,6 +443,46 @@ tt.func @gather_op(%arg0: tensor<128x16xf32>, %arg1: tensor<512x4xi32>) {
 
 // -----
 
+tt.func @sort_op(%arg0: tensor<128x16xf32>) {
+  // expected-error @below {{only the most minor dimension can be sorted}}
+  %0 = tt.sort %arg0 {axis = 0 : i32, descending = false} : tensor<128x16xf32>
+  tt.return
+}
+
+// -----
+
+tt.func @sort_op(%arg0: tensor<4x24xf32>) {
+  // expected-error @below {{sorted dimension must be a power of two}}
+  %0 = tt.sort %arg0 {axis = 1 : i32, descending = false} : tensor<4x24xf32>
+  tt.return
+}
+
+// -----
+
+tt.func @topk_op(%arg0: tensor<4x128xf32>) {
+  // expected-error @below {{k must be a power of two no larger than the sorted dimension}}
+  %0 = tt.topk %arg0 {axis = 1 : i32, k = 6 : i32} : tensor<4x128xf32> -> tensor<4x6xf32>
+  tt.return
+}
+
+// -----
+
+tt.func @topk_op(%arg0: tensor<4x128xf32>) {
+  // expected-error @below {{result must have k elements along the sorted dimension}}
+  %0 = tt.topk %arg0 {axis = 1 : i32, k = 8 : i32} : tensor<4x128xf32> -> tensor<4x16xf32>
+  tt.return
+}
+
+// -----
+
+tt.func @topk_op(%arg0: tensor<4x128xf32>) {
+  // expected-error @below {{indices must be i32 with the shape of the result}}
+  %0:2 = tt.topk %arg0 {axis = 1 : i32, k = 8 : i32} : tensor<4x128xf32> -> tensor<4x8xf32>, tensor<4x8xi64>
+  tt.return
+}
+
+// -----
+
 tt.func @invalid_desc_load(%arg0: !tt.tensordesc<tensor<16x16xf32>>) {
   %c = arith.constant 0 : i32
   // expected-error @below {{tensor desciptor block and tensor types must match}}
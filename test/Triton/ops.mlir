@@ -207,6 +207,21 @@ tt.func @scan_op(%ptr: tensor<1x2x4x!tt.ptr<f32>>, %v : tensor<1x2x4xf32>) {
   tt.return
 }
 
+// CHECK-LABEL: segmented_scan_op
+tt.func @segmented_scan_op(%ptr: tensor<2x8x!tt.ptr<i32>>, %v : tensor<2x8xi32>, %heads : tensor<2x8xi1>) {
+  // CHECK: tt.scan
+  // CHECK-SAME: exclusive
+  // CHECK-SAME: segmented
+  // CHECK: (tensor<2x8xi32>, tensor<2x8xi1>) -> (tensor<2x8xi32>, tensor<2x8xi1>)
+  %a:2 = "tt.scan"(%v, %heads) <{axis = 1 : i32, reverse = false, segmented, exclusive}>({
+  ^bb0(%arg0: i32, %arg1: i32):
+    %add = arith.addi %arg0, %arg1 : i32
+    tt.scan.return %add : i32
+  }) : (tensor<2x8xi32>, tensor<2x8xi1>) -> (tensor<2x8xi32>, tensor<2x8xi1>)
+  tt.store %ptr, %a#0 : tensor<2x8x!tt.ptr<i32>>
+  tt.return
+}
+
 // CHECK-LABEL: inline_asm
 // CHECK: tt.elementwise_inline_asm "shl.b32 $0, $0, 3;"
 tt.func @inline_asm(%0: tensor<512xi8>) {
@@ -258,6 +273,17 @@ tt.func @gather_op(%arg0: tensor<128x16xf32>, %arg1: tensor<512x16xi32>) -> tens
   tt.return %0 : tensor<512x16xf32>
 }
 
+// CHECK-LABEL: @sort_op
+tt.func @sort_op(%arg0: tensor<4x128xf32>, %arg1: tensor<4x128xi32>) -> (tensor<4x128xf32>, tensor<4x8xi32>) {
+  // CHECK-NEXT: %0 = tt.sort %arg0 {axis = 1 : i32, descending = true} : tensor<4x128xf32>
+  %0 = tt.sort %arg0 {axis = 1 : i32, descending = true} : tensor<4x128xf32>
+  // CHECK-NEXT: %1 = tt.topk %arg1 {axis = 1 : i32, is_unsigned, k = 8 : i32} : tensor<4x128xi32> -> tensor<4x8xi32>
+  %1 = tt.topk %arg1 {axis = 1 : i32, is_unsigned, k = 8 : i32} : tensor<4x128xi32> -> tensor<4x8xi32>
+  // CHECK-NEXT: %2:2 = tt.topk %arg0 {axis = 1 : i32, k = 8 : i32} : tensor<4x128xf32> -> tensor<4x8xf32>, tensor<4x8xi32>
+  %2:2 = tt.topk %arg0 {axis = 1 : i32, k = 8 : i32} : tensor<4x128xf32> -> tensor<4x8xf32>, tensor<4x8xi32>
+  tt.return %0, %1 : tensor<4x128xf32>, tensor<4x8xi32>
+}
+
 // CHECK-LABEL: @tma_gather
 tt.func @tma_gather(%arg0: !tt.tensordesc<tensor<1x128xbf16>>, %arg1: tensor<32xi32>, %arg2: i32) {
   // CHECK-NEXT: %0 = tt.experimental_descriptor_gather %arg0[%arg1, %arg2] : (!tt.tensordesc<tensor<1x128xbf16>>, tensor<32xi32>, i32) -> tensor<32x128xbf16>
@@ -194,6 +194,8 @@ struct ConvertTritonAMDGPUToLLVM
                       commonBenefit);
     populatePatterns7(mlir::triton::populateGatherOpToLLVMPatterns,
                       commonBenefit);
+    populatePatterns7(mlir::triton::populateSortOpToLLVMPatterns,
+                      commonBenefit);
 
     AMD::populateMemoryOpToLLVMPatterns(typeConverter, patterns, AMDBenefit);
     mlir::triton::populateMemoryOpToLLVMPatterns(typeConverter, targetInfo,
@@ -316,10 +316,22 @@ const ExtractionInfo kExtractionInfos[]{
     ExtractionInfo::build<double>({"'fp64'"}),
     // Note: types are e.g. '*fp32', so no closing quote is intentional.
     ExtractionInfo::build<void*>({"'*"}, extractPointer),
-    ExtractionInfo{
-        {"None", "'none'"}, 0, nullptr},  // Represent constexprs as None
+    ExtractionInfo{{"None", "'none'", "'constexpr'"},
+                   0,
+                   nullptr},  // Represent constexprs as None
 };
 
+// Signature metadata is a plan to extract the kernel parameters from the
+// arguments of launch(), built once per kernel.  Each argument is described by
+// the index of its extractor, or by kTupleMarker followed by the number of
+// elements of the tuple and the description of each element.  Constexprs, and
+// tuples that are constexprs as a whole, are skipped.
+constexpr char kTupleMarker = std::numeric_limits<char>::max();
+
+// Every kernel parameter is stored in a slot of this size, which fits and
+// aligns all the types of kExtractionInfos.
+constexpr std::size_t kParamSlotSize = sizeof(std::uint64_t);
+
 // Finds an extractor that supports a given type_repr in the extractor list.
 // Returns nullopt if no such extractor is found.
 std::optional<char> findExtractor(llvm::StringRef type_repr) {
@@ -332,16 +344,134 @@ std::optional<char> findExtractor(llvm::StringRef type_repr) {
   return std::nullopt;
 }
 
+// Appends the plan of an argument of type obj_type to signature_metadata.
+// Returns false, with a Python exception set, on unsupported types.
+bool appendSignatureMetadata(PyObject* obj_type,
+                             llvm::SmallVectorImpl<char>& signature_metadata) {
+  if (PyTuple_Check(obj_type)) {
+    Py_ssize_t size = PyTuple_GET_SIZE(obj_type);
+    if (size >= kTupleMarker) {
+      PyErr_Format(PyExc_TypeError,
+                   "tuples of more than %d kernel parameters are not supported",
+                   kTupleMarker - 1);
+      return false;
+    }
+    signature_metadata.push_back(kTupleMarker);
+    signature_metadata.push_back(static_cast<char>(size));
+    for (Py_ssize_t i = 0; i < size; ++i) {
+      if (!appendSignatureMetadata(PyTuple_GET_ITEM(obj_type, i),
+                                   signature_metadata)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  UniquePyObjectPtr repr(PyObject_Repr(obj_type));
+  if (!repr) {
+    return false;
+  }
+  UniquePyObjectPtr repr_str(
+      PyUnicode_AsEncodedString(repr.get(), "utf-8", "~E~"));
+  if (!repr_str) {
+    return false;
+  }
+  const char* repr_bytes = PyBytes_AsString(repr_str.get());
+  if (!repr_bytes) {
+    return false;
+  }
+  std::optional<std::uint8_t> extractor_idx = findExtractor(repr_bytes);
+  if (!extractor_idx.has_value()) {
+    PyErr_Format(PyExc_TypeError,
+                 "unexpected type %R in kernel signature, dir: %R", obj_type,
+                 PyObject_Dir(obj_type));
+    return false;
+  }
+  signature_metadata.push_back(extractor_idx.value());
+  return true;
+}
+
+// Returns the number of arguments described by signature_metadata, or -1 if
+// it is corrupted.
+int countSignatureArgs(llvm::ArrayRef<char> signature_metadata) {
+  int num_args = 0;
+  // Number of elements left to describe in each enclosing tuple.
+  llvm::SmallVector<int> pending;
+  for (std::size_t pos = 0; pos < signature_metadata.size(); ++pos) {
+    while (!pending.empty() && pending.back() == 0) {
+      pending.pop_back();
+    }
+    if (pending.empty()) {
+      ++num_args;
+    } else {
+      --pending.back();
+    }
+    if (signature_metadata[pos] == kTupleMarker) {
+      if (++pos == signature_metadata.size()) {
+        return -1;
+      }
+      pending.push_back(signature_metadata[pos]);
+    }
+  }
+  return num_args;
+}
+
+// Extracts the kernel parameters of arg, described at signature_metadata[pos],
+// to the next entries of params, whose values are stored at storage.  Advances
+// pos, params and storage past them.  Returns false, with a Python exception
+// set, on failure.
+bool extractArg(PyObject* arg, llvm::ArrayRef<char> signature_metadata,
+                std::size_t& pos, void**& params, char*& storage) {
+  if (pos >= signature_metadata.size()) {
+    PyErr_SetString(PyExc_ValueError, "corrupted signature metadata");
+    return false;
+  }
+  char converter_idx = signature_metadata[pos++];
+  if (converter_idx == kTupleMarker) {
+    if (pos >= signature_metadata.size()) {
+      PyErr_SetString(PyExc_ValueError, "corrupted signature metadata");
+      return false;
+    }
+    Py_ssize_t size = signature_metadata[pos++];
+    if (!PyTuple_Check(arg) || PyTuple_GET_SIZE(arg) != size) {
+      PyErr_Format(PyExc_TypeError,
+                   "Expected a tuple of %zd kernel arguments, but got %R", size,
+                   arg);
+      return false;
+    }
+    for (Py_ssize_t i = 0; i < size; ++i) {
+      if (!extractArg(PyTuple_GET_ITEM(arg, i), signature_metadata, pos, params,
+                      storage)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (converter_idx < 0 ||
+      static_cast<std::size_t>(converter_idx) >= std::size(kExtractionInfos)) {
+    PyErr_SetString(PyExc_ValueError, "corrupted signature metadata");
+    return false;
+  }
+  const ExtractionInfo& extraction_info = kExtractionInfos[converter_idx];
+  if (extraction_info.size == 0) {
+    return true;  // skip adding constexpr parameters
+  }
+  *params++ = storage;
+  storage += kParamSlotSize;
+  return extraction_info.extractor(arg, params[-1]);
+}
+
 PyDoc_STRVAR(buildSignatureMetadata__doc__,
              R"(buildSignatureMetadata(signature_iterator) -> bytes
 
 Build a metadata object describing the signature of a kernel.
 
 This can then be passed as the signature_metadata parameter to the launch()
-function.
+function, which then takes the arguments of the kernel as they are: tuple
+arguments are flattened, and constexpr arguments skipped, by launch() itself.
 
-:param signature: list of types describing the signature of a kernel,
-    specialized parameters should be represented with None
+:param signature: list of types describing the signature of a kernel, where
+    tuple arguments are tuples of types, and specialized parameters are
+    represented with None or 'constexpr'
 :type signature: sequence or iterable
 :return: an opaque metadata object which can then be passed to launch()
 :rtype: bytes
@@ -359,27 +489,9 @@ PyObject* buildSignatureMetadata(PyObject* self, PyObject* args) {
 
   llvm::SmallVector<char, 16> signature_metadata;
   while (UniquePyObjectPtr obj_type{PyIter_Next(signature)}) {
-    UniquePyObjectPtr repr(PyObject_Repr(obj_type.get()));
-    if (!repr) {
-      return nullptr;
-    }
-    UniquePyObjectPtr repr_str(
-        PyUnicode_AsEncodedString(repr.get(), "utf-8", "~E~"));
-    if (!repr_str) {
-      return nullptr;
-    }
-    const char* repr_bytes = PyBytes_AsString(repr_str.get());
-    if (!repr_bytes) {
-      return nullptr;
-    }
-    std::optional<std::uint8_t> extractor_idx = findExtractor(repr_bytes);
-    if (!extractor_idx.has_value()) {
-      PyErr_Format(PyExc_TypeError,
-                   "unexpected type %R in kernel signature, dir: %R",
-                   obj_type.get(), PyObject_Dir(obj_type.get()));
+    if (!appendSignatureMetadata(obj_type.get(), signature_metadata)) {
       return nullptr;
     }
-    signature_metadata.push_back(extractor_idx.value());
   }
   if (PyErr_Occurred()) {
     return nullptr;
@@ -444,7 +556,8 @@ Launch a kernel on an Nvidia GPU.
 :type signature_metadata: bytes
 :param global_scratch: pointer to global scratch memory
 :type global_scratch: pointer
-:param kernel_args: kernel parameters
+:param kernel_args: kernel arguments, with their tuples and constexprs, in the
+    order of the signature given to build_signature_metadata
 :type kernel_args: tuple
 
 :raises RuntimeError: on kernel launch failure
@@ -489,39 +602,34 @@ PyObject* launch(PyObject* self, PyObject* args) {
       PySequence_Fast_ITEMS(fast_kernel_args.get()),
       PySequence_Fast_GET_SIZE(fast_kernel_args.get()));
 
-  if (signature_metadata.size() != kernel_args_data.size()) {
-    PyErr_Format(PyExc_TypeError,
-                 "Expected kernel to have %d parameters, but got %d",
-                 signature_metadata.size(), kernel_args_data.size());
-    return nullptr;
-  }
-
-  // +1 for the global scratch pointer.
-  std::size_t num_params = signature_metadata.size() + 1;
-  // Use alloca to set up kernel parameters on the stack and avoid dynamic
-  // memory allocations.
-  config.params = static_cast<void**>(alloca(num_params * sizeof(void*)));
-  // This loop has to stay in the same function that owns params, since we are
-  // using alloca to allocate pointers to it on the stack of the function.
-  std::size_t params_idx = 0;
-  for (const auto& [converter_idx, arg] :
-       llvm::zip(signature_metadata, kernel_args_data)) {
-    if (converter_idx >= std::size(kExtractionInfos)) {
-      PyErr_SetString(PyExc_ValueError, "corrupted signature metadata");
-      return nullptr;
-    }
-    const ExtractionInfo& extraction_info = kExtractionInfos[converter_idx];
-    if (extraction_info.size == 0) {
-      continue;  // skip adding constexpr parameters
+  // Every parameter takes at most one entry of the signature metadata, +1 for
+  // the global scratch pointer.  Use alloca to set up kernel parameters on the
+  // stack and avoid dynamic memory allocations; the extraction below only
+  // writes to the memory allocated here.
+  std::size_t max_params = signature_metadata.size() + 1;
+  config.params = static_cast<void**>(alloca(max_params * sizeof(void*)));
+  char* storage = static_cast<char*>(alloca(max_params * kParamSlotSize));
+  void** params = config.params;
+  std::size_t pos = 0;
+  bool too_many_args = false;
+  for (PyObject* arg : kernel_args_data) {
+    if (pos == signature_metadata.size()) {
+      too_many_args = true;
+      break;
     }
-    config.params[params_idx] = alloca(extraction_info.size);
-    if (!extraction_info.extractor(arg, config.params[params_idx])) {
+    if (!extractArg(arg, signature_metadata, pos, params, storage)) {
       return nullptr;
     }
-    ++params_idx;
   }
-  config.params[params_idx] = alloca(sizeof(void*));
-  if (!extractPointer(global_scratch, config.params[params_idx])) {
+  if (too_many_args || pos != signature_metadata.size()) {
+    PyErr_Format(PyExc_TypeError,
+                 "Expected kernel to have %d parameters, but got %zu",
+                 countSignatureArgs(signature_metadata),
+                 kernel_args_data.size());
+    return nullptr;
+  }
+  *params = storage;
+  if (!extractPointer(global_scratch, *params)) {
     return nullptr;
   }
 
@@ -91,52 +91,21 @@ def ty_to_cpp(ty):
     }[ty]
 
 
-def flatten_tuples(xs):
-    """Recursively flattens tuple elements in xs."""
-    for x in xs:
-        if isinstance(x, tuple):
-            yield from flatten_tuples(x)
-        else:
-            yield x
-
-
 def make_launcher(constants : dict[int, str], signature : dict[int, any]) -> Callable[..., None]:
     # Here, signature can look like:
     #  {'_0': 'i32',
     #   'Ptrs': (),
     #   '_1': 'constexpr',
-    #   'values': '[*f32, constexpr]',
+    #   'values': ('*f32', 'constexpr'),
     #   'out_tuple': 'constexpr'}
-    # We want to remove the constexprs, flatten the tuples, and remove any more
-    # constexprs. If we remove them all at the end, we won't be able to remove
-    # entire tuples that are a single constexpr. If we remove them before
-    # flattening, we will miss mixed-tuples. So we do it twice.
-
-    def _serialize_signature(sig):
-        if isinstance(sig, tuple):
-            return ','.join(map(_serialize_signature, sig))
-        return sig
-    
-    # Remember & remove all the constexpr before flattening.
-    constant_indices_before_flattening = {i for i, [k, v] in enumerate(signature.items()) if v == 'constexpr'}
-    # constant_indices_before_flattening = [2, 4]
-    signature = {k: v for k, v in signature.items() if v != 'constexpr'}
-    # signature = {'_0': 'i32', 'Ptrs': (), 'values': '[*f32, constexpr]'}
-
-    # Flatten.
-    signature = ','.join(map(_serialize_signature, signature.values()))
-    # signature = 'i32,,*f32,constexpr'
-    signature = list(filter(bool, signature.split(',')))
-    # signature = ['i32', '*f32', 'constexpr']
-
-    # Remove any constexprs after flattening.
-    constant_indices_after_flattening = {i for i, s in enumerate(signature) if s == 'constexpr'}
-    # constant_indices_after_flattening = [2]
-    signature = {i: s for i, s in enumerate(signature) if s != 'constexpr'}
-    # signature = {0: 'i32', 1: '*f32'}
-
-    signature_metadata = cuda_utils.build_signature_metadata(
-            ty for ty in signature.values())
+    # and the arguments of a launch something like:
+    #  (8, (), 5, (ptr, 4), (2, 2, 2))
+    # build_signature_metadata compiles the signature once into a plan, which
+    # cuda_utils.launch follows on the arguments as they are: it flattens the
+    # tuples and skips the constexprs, whole tuples included, so that a launch
+    # does no work in Python. Given the example above, the kernel parameters
+    # are (8, ptr).
+    signature_metadata = cuda_utils.build_signature_metadata(iter(signature.values()))
 
     def wrapper(grid_dim_x: int, grid_dim_y: int, grid_dim_z: int,
                 stream: int, kernel: int, global_scratch: any,
@@ -145,27 +114,10 @@ def make_launcher(constants : dict[int, str], signature : dict[int, any]) -> Cal
                 launch_enter_hook: Callable[..., None],
                 launch_exit_hook: Callable[..., None],
                 *args: any) -> None:
-        # Given the example above, args would look something like:
-        # args = [8, (), 5, (3, 4), (2, 2, 2)]
-        # constant_indices_before_flattening = [2, 4]
-        # Remove constantexprs before flattening:
-        non_const_args = [arg
-            for idx, arg in enumerate(args)
-            if idx not in constant_indices_before_flattening
-        ]
-        # non_const_args = [8, (), (3, 4)]
-        non_const_args = flatten_tuples(non_const_args)
-        # non_const_args = [8, 3, 4]
-        # constant_indices_after_flattening = [2]
-        non_const_args = [arg
-            for idx, arg in enumerate(non_const_args)
-            if idx not in constant_indices_after_flattening
-        ]
-        # non_const_args = [8, 3]
         cuda_utils.launch(grid_dim_x, grid_dim_y, grid_dim_z, stream, kernel,
                           packed_metadata, hook_args, launch_enter_hook,
                           launch_exit_hook, signature_metadata, global_scratch,
-                          non_const_args)
+                          args)
     return wrapper
 
 
@@ -10,7 +10,7 @@
 
 namespace proton {
 
-enum class OutputFormat { Hatchet, Count };
+enum class OutputFormat { Hatchet, HatchetCompact, ChromeTrace, Count };
 
 class Data : public ScopeInterface {
 public:
@@ -35,6 +35,10 @@ public:
   /// Clear all caching data.
   virtual void clear() = 0;
 
+  /// Apply the updates that are buffered by the data.
+  /// The data is flushed before it is dumped.
+  virtual void flush() {}
+
   /// Dump the data to the given output format.
   void dump(OutputFormat outputFormat);
 
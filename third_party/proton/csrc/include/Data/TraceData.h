@@ -1,14 +1,21 @@
 #ifndef PROTON_DATA_TRACE_DATA_H_
 #define PROTON_DATA_TRACE_DATA_H_
 
+#include "Context/Context.h"
 #include "Data.h"
+#include <map>
+#include <unordered_map>
 
 namespace proton {
 
+/// TraceData records every scope and op as a separate event on a timeline,
+/// rather than aggregating metrics per calling context like TreeData.
 class TraceData : public Data {
 public:
-  using Data::Data;
-  virtual ~TraceData() = default;
+  TraceData(const std::string &path, ContextSource *contextSource);
+  virtual ~TraceData();
+
+  TraceData(const std::string &path) : TraceData(path, nullptr) {}
 
   size_t addOp(size_t scopeId, const std::string &name) override;
 
@@ -27,7 +34,22 @@ protected:
   void exitScope(const Scope &scope) override final;
 
 private:
+  void init();
+  void recordClockOffset(uint64_t deviceType);
+  void dumpChromeTrace(std::ostream &os) const;
   void doDump(std::ostream &os, OutputFormat outputFormat) const override;
+
+  // `trace` and `scopeIdToEventId` can be accessed by both the user thread and
+  // the background threads concurrently, so methods that access them should be
+  // protected by a (shared) mutex.
+  class Trace;
+  std::unique_ptr<Trace> trace;
+  // ScopeId -> EventId
+  std::unordered_map<size_t, size_t> scopeIdToEventId;
+  // Device type -> host time minus the time of the device activity clock of
+  // its profiler backend, in ns. Recorded once per session, with the first
+  // kernel of the device type, to place kernels on the host timeline.
+  std::map<uint64_t, int64_t> clockOffsets;
 };
 
 } // namespace proton
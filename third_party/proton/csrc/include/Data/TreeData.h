@@ -3,8 +3,11 @@
 
 #include "Context/Context.h"
 #include "Data.h"
+#include "Utility/Set.h"
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
 namespace proton {
 
@@ -25,6 +28,8 @@ public:
 
   void clear() override;
 
+  void flush() override;
+
 protected:
   // ScopeInterface
   void enterScope(const Scope &scope) override;
@@ -32,10 +37,30 @@ protected:
   void exitScope(const Scope &scope) override;
 
 private:
+  // Scopes, ops and metrics are buffered by the calling thread and merged into
+  // `tree` when the data is flushed, so that user threads and profiler
+  // callback threads don't contend on `mutex`.
+  struct ScopeUpdate;
+  struct MetricDeltas;
+  struct ThreadBuffer;
+
   void init();
-  void dumpHatchet(std::ostream &os) const;
+  void dumpHatchet(std::ostream &os, bool compact) const;
   void doDump(std::ostream &os, OutputFormat outputFormat) const override;
 
+  ThreadBuffer &getThreadBuffer();
+  // Merges all buffers if the calling thread's buffer, which must be locked by
+  // `bufferLock`, is full.
+  void flushIfFull(ThreadBuffer &buffer,
+                   std::unique_lock<std::mutex> &bufferLock);
+  // Returns false if the update is an op whose scope hasn't been merged.
+  bool applyScopeUpdate(const ScopeUpdate &update);
+  // Returns false if the scope of the metrics hasn't been merged.
+  bool applyMetricDeltas(MetricDeltas &deltas);
+  // Merges the updates buffered by all threads and optionally forgets all
+  // scopes afterwards. `mutex` must be held exclusively.
+  void mergeThreadBuffers(bool clearScopes);
+
   // `tree` and `scopeIdToContextId` can be accessed by both the user thread and
   // the background threads concurrently, so methods that access them should be
   // protected by a (shared) mutex.
@@ -43,6 +68,19 @@ private:
   std::unique_ptr<Tree> tree;
   // ScopeId -> ContextId
   std::unordered_map<size_t, size_t> scopeIdToContextId;
+
+  // The ids of all scopes that have been entered or added as ops, including
+  // the ones that haven't been merged yet, so that threads agree on whether an
+  // op is added under an existing scope.
+  AtomicIdSet scopeIds;
+  // Ops and their metrics that were collected before the scope that the ops
+  // are added under
+  std::vector<ScopeUpdate> deferredScopeUpdates;
+  std::vector<MetricDeltas> deferredMetricDeltas;
+
+  const size_t dataId;
+  std::mutex threadBuffersMutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
 };
 
 } // namespace proton
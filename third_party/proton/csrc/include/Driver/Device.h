@@ -43,6 +43,10 @@ Device getDevice(DeviceType type, uint64_t index);
 
 const std::string getDeviceTypeString(DeviceType type);
 
+/// Returns the current time in ns on the clock that the profiler backend of
+/// `type` uses to timestamp device activities.
+uint64_t getDeviceTimestamp(DeviceType type);
+
 }; // namespace proton
 
 #endif // PROTON_DRIVER_DEVICE_H_
@@ -0,0 +1,90 @@
+#ifndef PROTON_UTILITY_JSON_WRITER_H_
+#define PROTON_UTILITY_JSON_WRITER_H_
+
+#include "nlohmann/json.hpp"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace proton {
+
+/// Writes a JSON document directly to a stream, without building it in memory
+/// first. The output matches `nlohmann::json::dump(indent)`; a negative
+/// `indent` writes compact JSON.
+class JsonWriter {
+public:
+  JsonWriter(std::ostream &os, int indent = -1) : os(os), indent(indent) {}
+
+  void beginObject() {
+    beginValue();
+    os << '{';
+    scopes.push_back(true);
+  }
+
+  void endObject() { endScope('}'); }
+
+  void beginArray() {
+    beginValue();
+    os << '[';
+    scopes.push_back(true);
+  }
+
+  void endArray() { endScope(']'); }
+
+  /// Writes the key of the next member of the current object.
+  void key(const std::string &name) {
+    beginElement();
+    os << nlohmann::json(name).dump() << (indent >= 0 ? ": " : ":");
+    pendingKey = true;
+  }
+
+  /// Writes a scalar value.
+  void value(const nlohmann::json &value) {
+    beginValue();
+    os << value.dump(indent);
+  }
+
+private:
+  void newLine(size_t depth) {
+    if (indent < 0)
+      return;
+    os << '\n' << std::string(depth * indent, ' ');
+  }
+
+  void beginElement() {
+    if (scopes.empty())
+      return;
+    if (!scopes.back())
+      os << ',';
+    scopes.back() = false;
+    newLine(scopes.size());
+  }
+
+  void beginValue() {
+    // Object members are introduced by `key`
+    if (pendingKey) {
+      pendingKey = false;
+      return;
+    }
+    beginElement();
+  }
+
+  void endScope(char close) {
+    bool empty = scopes.back();
+    scopes.pop_back();
+    if (!empty)
+      newLine(scopes.size());
+    os << close;
+  }
+
+  std::ostream &os;
+  const int indent;
+  bool pendingKey = false;
+  // Whether each enclosing object or array is still empty
+  std::vector<bool> scopes;
+};
+
+} // namespace proton
+
+#endif // PROTON_UTILITY_JSON_WRITER_H_
@@ -1,8 +1,13 @@
 #ifndef PROTON_UTILITY_SET_H_
 #define PROTON_UTILITY_SET_H_
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <set>
 #include <shared_mutex>
+#include <unordered_set>
+#include <vector>
 
 namespace proton {
 
@@ -40,6 +45,89 @@ private:
   std::shared_mutex mutex;
 };
 
+/// A set of densely allocated ids, such as scope ids, that can be updated
+/// concurrently without a lock. Ids are stored as bits in lazily allocated
+/// pages; ids that are out of the range of the pages are kept in a locked set.
+class AtomicIdSet {
+public:
+  AtomicIdSet() : pages(NumPages) {}
+
+  ~AtomicIdSet() {
+    for (auto &page : pages)
+      delete[] page.load();
+  }
+
+  AtomicIdSet(const AtomicIdSet &) = delete;
+  AtomicIdSet &operator=(const AtomicIdSet &) = delete;
+
+  /// Returns true if the id was not in the set.
+  bool insert(size_t id) {
+    auto pageId = id / IdsPerPage;
+    if (pageId >= NumPages) {
+      std::lock_guard<std::mutex> lock(mutex);
+      return overflowIds.insert(id).second;
+    }
+    auto offset = id % IdsPerPage;
+    uint64_t mask = uint64_t(1) << (offset % 64);
+    auto &word = getPage(pageId)[offset / 64];
+    return !(word.fetch_or(mask, std::memory_order_relaxed) & mask);
+  }
+
+  bool contain(size_t id) {
+    auto pageId = id / IdsPerPage;
+    if (pageId >= NumPages) {
+      std::lock_guard<std::mutex> lock(mutex);
+      return overflowIds.count(id);
+    }
+    auto *words = pages[pageId].load(std::memory_order_acquire);
+    if (!words)
+      return false;
+    auto offset = id % IdsPerPage;
+    uint64_t mask = uint64_t(1) << (offset % 64);
+    return words[offset / 64].load(std::memory_order_relaxed) & mask;
+  }
+
+  /// Removes all ids. The pages are zeroed in place and kept until the
+  /// destructor: other threads may be using them, and an insert that races
+  /// with the clear lands in the same page, before or after its word is
+  /// zeroed, rather than in a page that is being dropped.
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &page : pages) {
+      auto *words = page.load(std::memory_order_acquire);
+      if (!words)
+        continue;
+      for (size_t i = 0; i < WordsPerPage; ++i)
+        words[i].store(0, std::memory_order_relaxed);
+    }
+    overflowIds.clear();
+  }
+
+private:
+  static constexpr size_t IdsPerPage = 1 << 20;
+  static constexpr size_t WordsPerPage = IdsPerPage / 64;
+  // The pages cover the first 2^32 ids
+  static constexpr size_t NumPages = 1 << 12;
+
+  std::atomic<uint64_t> *getPage(size_t pageId) {
+    auto *page = pages[pageId].load(std::memory_order_acquire);
+    if (page)
+      return page;
+    auto *newPage = new std::atomic<uint64_t>[WordsPerPage]();
+    if (pages[pageId].compare_exchange_strong(page, newPage,
+                                              std::memory_order_acq_rel)) {
+      return newPage;
+    }
+    // Another thread allocated the page first
+    delete[] newPage;
+    return page;
+  }
+
+  std::vector<std::atomic<std::atomic<uint64_t> *>> pages;
+  std::mutex mutex;
+  std::unordered_set<size_t> overflowIds;
+};
+
 } // namespace proton
 
 #endif // PROTON_UTILITY_MAP_H_
@@ -10,6 +10,7 @@
 namespace proton {
 
 void Data::dump(OutputFormat outputFormat) {
+  flush();
   std::shared_lock<std::shared_mutex> lock(mutex);
 
   std::unique_ptr<std::ostream> out;
@@ -27,13 +28,24 @@ OutputFormat parseOutputFormat(const std::string &outputFormat) {
   if (toLower(outputFormat) == "hatchet") {
     return OutputFormat::Hatchet;
   }
+  if (toLower(outputFormat) == "hatchet_compact") {
+    return OutputFormat::HatchetCompact;
+  }
+  if (toLower(outputFormat) == "chrome_trace") {
+    return OutputFormat::ChromeTrace;
+  }
   throw std::runtime_error("Unknown output format: " + outputFormat);
 }
 
 const std::string outputFormatToString(OutputFormat outputFormat) {
-  if (outputFormat == OutputFormat::Hatchet) {
+  // Compact hatchet profiles are read the same way as indented ones
+  if (outputFormat == OutputFormat::Hatchet ||
+      outputFormat == OutputFormat::HatchetCompact) {
     return "hatchet";
   }
+  if (outputFormat == OutputFormat::ChromeTrace) {
+    return "chrome_trace";
+  }
   throw std::runtime_error("Unknown output format: " +
                            std::to_string(static_cast<int>(outputFormat)));
 }
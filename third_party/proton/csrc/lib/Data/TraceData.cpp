@@ -1,31 +1,334 @@
 #include "Data/TraceData.h"
-#include "Utility/Errors.h"
+#include "Context/Context.h"
+#include "Data/Metric.h"
+#include "Driver/Device.h"
+#include "Utility/JsonWriter.h"
+#include "nlohmann/json.hpp"
 
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+
+using json = nlohmann::json;
 
 namespace proton {
 
-void TraceData::enterScope(const Scope &scope) { throw NotImplemented(); }
+namespace {
+
+uint64_t getHostTimestamp() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+std::string getContextPath(const std::vector<Context> &contexts) {
+  std::string path;
+  for (auto &context : contexts) {
+    if (!path.empty())
+      path += "/";
+    path += context.name;
+  }
+  return path;
+}
+
+} // namespace
+
+class TraceData::Trace {
+public:
+  struct TraceEvent {
+    inline static const size_t DummyId = std::numeric_limits<size_t>::max();
+
+    TraceEvent() = default;
+    TraceEvent(size_t id, size_t parentId, const std::string &name,
+               const std::vector<Context> &contexts, uint64_t threadId,
+               uint64_t startTime)
+        : id(id), parentId(parentId), name(name), contexts(contexts),
+          threadId(threadId), startTime(startTime) {}
+
+    bool isFinished() const { return endTime != 0; }
+
+    size_t id = DummyId;
+    // The enclosing event if this is an op launched under another event
+    size_t parentId = DummyId;
+    std::string name{};
+    std::vector<Context> contexts{};
+    uint64_t threadId{};
+    // Host timestamps in ns. Ops only have a start time, which is the time
+    // they are launched.
+    uint64_t startTime{};
+    uint64_t endTime{};
+    std::map<MetricKind, std::shared_ptr<Metric>> metrics = {};
+    std::map<std::string, FlexibleMetric> flexibleMetrics = {};
+  };
+
+  Trace() = default;
+
+  size_t addEvent(size_t parentId, const std::string &name,
+                  const std::vector<Context> &contexts) {
+    if (chunks.empty() || chunks.back().size() == ChunkSize) {
+      chunks.emplace_back();
+      chunks.back().reserve(ChunkSize);
+    }
+    auto id = numEvents++;
+    chunks.back().emplace_back(id, parentId, name, contexts, getThreadId(),
+                               getHostTimestamp());
+    return id;
+  }
+
+  TraceEvent &getEvent(size_t id) {
+    return chunks.at(id / ChunkSize).at(id % ChunkSize);
+  }
+
+  const TraceEvent &getEvent(size_t id) const {
+    return chunks.at(id / ChunkSize).at(id % ChunkSize);
+  }
+
+  /// Visits events in the order they were recorded.
+  template <typename FnT> void walk(FnT &&fn) const {
+    for (auto &chunk : chunks) {
+      for (auto &event : chunk) {
+        fn(event);
+      }
+    }
+  }
+
+private:
+  // Events are stored in fixed-size chunks that are never reallocated, so
+  // recording an event never copies previously recorded events.
+  inline static const size_t ChunkSize = 4096;
 
-void TraceData::exitScope(const Scope &scope) { throw NotImplemented(); }
+  uint64_t getThreadId() {
+    auto [it, inserted] =
+        threadIds.try_emplace(std::this_thread::get_id(), threadIds.size());
+    return it->second;
+  }
+
+  size_t numEvents = 0;
+  std::vector<std::vector<TraceEvent>> chunks;
+  // OS thread id -> sequential thread id used in the output
+  std::map<std::thread::id, uint64_t> threadIds;
+};
+
+void TraceData::init() { trace = std::make_unique<Trace>(); }
+
+void TraceData::enterScope(const Scope &scope) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  std::vector<Context> contexts;
+  if (contextSource != nullptr)
+    contexts = contextSource->getContexts();
+  auto name = scope.name;
+  if (name.empty() && !contexts.empty())
+    name = contexts.back().name;
+  scopeIdToEventId[scope.scopeId] =
+      trace->addEvent(Trace::TraceEvent::DummyId, name, contexts);
+}
+
+void TraceData::exitScope(const Scope &scope) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto scopeIdIt = scopeIdToEventId.find(scope.scopeId);
+  if (scopeIdIt == scopeIdToEventId.end())
+    return;
+  trace->getEvent(scopeIdIt->second).endTime = getHostTimestamp();
+}
 
 size_t TraceData::addOp(size_t scopeId, const std::string &name) {
-  throw NotImplemented();
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto scopeIdIt = scopeIdToEventId.find(scopeId);
+  if (scopeIdIt == scopeIdToEventId.end()) {
+    // Obtain the current context
+    std::vector<Context> contexts;
+    if (contextSource != nullptr)
+      contexts = contextSource->getContexts();
+    // Add an op under the current context
+    if (!name.empty())
+      contexts.emplace_back(name);
+    auto opName = contexts.empty() ? name : contexts.back().name;
+    scopeIdToEventId[scopeId] =
+        trace->addEvent(Trace::TraceEvent::DummyId, opName, contexts);
+  } else {
+    // Add a new event under the existing one
+    auto parentId = scopeIdIt->second;
+    auto contexts = trace->getEvent(parentId).contexts;
+    contexts.emplace_back(name);
+    scopeId = Scope::getNewScopeId();
+    scopeIdToEventId[scopeId] = trace->addEvent(parentId, name, contexts);
+  }
+  return scopeId;
 }
 
 void TraceData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
-  throw NotImplemented();
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto scopeIdIt = scopeIdToEventId.find(scopeId);
+  // The profile data is deactivated, ignore the metric
+  if (scopeIdIt == scopeIdToEventId.end())
+    return;
+  if (metric->getKind() == MetricKind::Kernel)
+    recordClockOffset(
+        std::get<uint64_t>(metric->getValue(KernelMetric::DeviceType)));
+  auto &event = trace->getEvent(scopeIdIt->second);
+  if (event.metrics.find(metric->getKind()) == event.metrics.end())
+    event.metrics.emplace(metric->getKind(), metric);
+  else
+    event.metrics[metric->getKind()]->updateMetric(*metric);
 }
 
 void TraceData::addMetrics(
     size_t scopeId, const std::map<std::string, MetricValueType> &metrics) {
-  throw NotImplemented();
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto scopeIdIt = scopeIdToEventId.find(scopeId);
+  // The profile data is deactivated, ignore the metric
+  if (scopeIdIt == scopeIdToEventId.end())
+    return;
+  auto &event = trace->getEvent(scopeIdIt->second);
+  for (auto [metricName, metricValue] : metrics) {
+    if (event.flexibleMetrics.find(metricName) ==
+        event.flexibleMetrics.end()) {
+      event.flexibleMetrics.emplace(metricName,
+                                    FlexibleMetric(metricName, metricValue));
+    } else {
+      event.flexibleMetrics.at(metricName).updateValue(metricValue);
+    }
+  }
 }
 
-void TraceData::clear() { throw NotImplemented(); }
+void TraceData::recordClockOffset(uint64_t deviceType) {
+  if (clockOffsets.count(deviceType))
+    return;
+  // Take the device time between two host times, and assume it is halfway.
+  auto hostStart = getHostTimestamp();
+  auto deviceTime = getDeviceTimestamp(static_cast<DeviceType>(deviceType));
+  auto hostEnd = getHostTimestamp();
+  auto hostTime = hostStart + (hostEnd - hostStart) / 2;
+  clockOffsets[deviceType] = static_cast<int64_t>(hostTime - deviceTime);
+}
+
+void TraceData::clear() {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  scopeIdToEventId.clear();
+}
+
+// Emits the trace in the Chrome trace event format, which can be loaded by
+// chrome://tracing and Perfetto. Events are written to `os` one at a time.
+// Host events are placed on a single "Host" process with one track per
+// thread. Kernels are placed on one process per device, with the timestamps
+// reported by the profiler backend moved to the host clock.
+void TraceData::dumpChromeTrace(std::ostream &os) const {
+  const uint64_t hostPid = 0;
+  JsonWriter writer(os);
+  writer.beginObject();
+  writer.key("displayTimeUnit");
+  writer.value("ns");
+  writer.key("traceEvents");
+  writer.beginArray();
+  writer.value({{"name", "process_name"},
+                {"ph", "M"},
+                {"pid", hostPid},
+                {"args", {{"name", "Host"}}}});
+  // (device type, device id) -> pid
+  std::map<std::pair<uint64_t, uint64_t>, uint64_t> devicePids;
+  auto getDevicePid = [&](uint64_t deviceType, uint64_t deviceId) {
+    auto [it, inserted] = devicePids.try_emplace({deviceType, deviceId},
+                                                 devicePids.size() + 1);
+    if (inserted) {
+      auto deviceName =
+          getDeviceTypeString(static_cast<DeviceType>(deviceType)) + " " +
+          std::to_string(deviceId);
+      writer.value({{"name", "process_name"},
+                    {"ph", "M"},
+                    {"pid", it->second},
+                    {"args", {{"name", deviceName}}}});
+    }
+    return it->second;
+  };
+  auto toMicroseconds = [](uint64_t ns) { return ns / 1000.0; };
+
+  trace->walk([&](const Trace::TraceEvent &event) {
+    json traceEvent = {{"name", event.name}, {"args", json::object()}};
+    auto &args = traceEvent["args"];
+    args["context"] = getContextPath(event.contexts);
+    std::shared_ptr<KernelMetric> kernelMetric;
+    for (auto [metricKind, metric] : event.metrics) {
+      if (metricKind == MetricKind::Kernel) {
+        kernelMetric = std::dynamic_pointer_cast<KernelMetric>(metric);
+        args[kernelMetric->getValueName(KernelMetric::Invocations)] =
+            std::get<uint64_t>(
+                kernelMetric->getValue(KernelMetric::Invocations));
+      } else if (metricKind == MetricKind::PCSampling) {
+        auto pcSamplingMetric =
+            std::dynamic_pointer_cast<PCSamplingMetric>(metric);
+        for (size_t i = 0; i < PCSamplingMetric::Count; i++) {
+          std::visit(
+              [&](auto &&value) {
+                args[pcSamplingMetric->getValueName(i)] = value;
+              },
+              pcSamplingMetric->getValues()[i]);
+        }
+      } else {
+        throw std::runtime_error("MetricKind not supported");
+      }
+    }
+    for (auto [_, flexibleMetric] : event.flexibleMetrics) {
+      std::visit(
+          [&](auto &&value) { args[flexibleMetric.getValueName(0)] = value; },
+          flexibleMetric.getValues()[0]);
+    }
+    if (kernelMetric) {
+      auto startTime =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::StartTime));
+      auto endTime =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::EndTime));
+      auto deviceId =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceId));
+      auto deviceType =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceType));
+      auto offsetIt = clockOffsets.find(deviceType);
+      auto offset = offsetIt != clockOffsets.end() ? offsetIt->second : 0;
+      traceEvent["cat"] = "kernel";
+      traceEvent["ph"] = "X";
+      traceEvent["pid"] = getDevicePid(deviceType, deviceId);
+      traceEvent["tid"] = 0;
+      traceEvent["ts"] = toMicroseconds(startTime + offset);
+      traceEvent["dur"] = toMicroseconds(endTime - startTime);
+    } else if (event.isFinished()) {
+      traceEvent["cat"] = "scope";
+      traceEvent["ph"] = "X";
+      traceEvent["pid"] = hostPid;
+      traceEvent["tid"] = event.threadId;
+      traceEvent["ts"] = toMicroseconds(event.startTime);
+      traceEvent["dur"] = toMicroseconds(event.endTime - event.startTime);
+    } else {
+      // An op that has been launched but has no device activity, or a scope
+      // that has not been exited yet
+      traceEvent["cat"] = "op";
+      traceEvent["ph"] = "i";
+      traceEvent["s"] = "t";
+      traceEvent["pid"] = hostPid;
+      traceEvent["tid"] = event.threadId;
+      traceEvent["ts"] = toMicroseconds(event.startTime);
+    }
+    writer.value(traceEvent);
+  });
+  writer.endArray();
+  writer.endObject();
+  os << std::endl;
+}
 
 void TraceData::doDump(std::ostream &os, OutputFormat outputFormat) const {
-  throw NotImplemented();
+  if (outputFormat == OutputFormat::ChromeTrace) {
+    dumpChromeTrace(os);
+  } else {
+    throw std::logic_error("OutputFormat not supported");
+  }
 }
 
+TraceData::TraceData(const std::string &path, ContextSource *contextSource)
+    : Data(path, contextSource) {
+  init();
+}
+
+TraceData::~TraceData() {}
+
 } // namespace proton
@@ -2,13 +2,19 @@
 #include "Context/Context.h"
 #include "Data/Metric.h"
 #include "Driver/Device.h"
+#include "Utility/JsonWriter.h"
 #include "nlohmann/json.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <mutex>
 #include <set>
 #include <stdexcept>
+#include <unordered_set>
 
 using json = nlohmann::json;
 
@@ -16,6 +22,10 @@ namespace proton {
 
 class TreeData::Tree {
 public:
+  // Metrics of a node indexed by their kind
+  using MetricTable = std::array<std::shared_ptr<Metric>,
+                                 static_cast<size_t>(MetricKind::Count)>;
+
   struct TreeNode : public Context {
     inline static const size_t RootId = 0;
     inline static const size_t DummyId = std::numeric_limits<size_t>::max();
@@ -27,47 +37,42 @@ public:
         : id(id), parentId(parentId), Context(name) {}
     virtual ~TreeNode() = default;
 
-    void addChild(const Context &context, size_t id) { children[context] = id; }
-
-    bool hasChild(const Context &context) const {
-      return children.find(context) != children.end();
-    }
-
-    size_t getChild(const Context &context) const {
-      return children.at(context);
+    std::shared_ptr<Metric> &getMetric(MetricKind kind) {
+      return metrics[static_cast<size_t>(kind)];
     }
 
     size_t parentId = DummyId;
     size_t id = DummyId;
-    std::map<Context, size_t> children = {};
-    std::map<MetricKind, std::shared_ptr<Metric>> metrics = {};
-    std::map<std::string, FlexibleMetric> flexibleMetrics = {};
+    // Child ids in insertion order
+    std::vector<size_t> children = {};
+    MetricTable metrics = {};
+    std::unordered_map<std::string, FlexibleMetric> flexibleMetrics = {};
     friend class Tree;
   };
 
-  Tree() {
-    treeNodeMap.try_emplace(TreeNode::RootId, TreeNode::RootId, "ROOT");
-  }
+  Tree() { treeNodes.emplace_back(TreeNode::RootId, "ROOT"); }
 
   size_t addNode(const Context &context, size_t parentId) {
-    if (treeNodeMap[parentId].hasChild(context)) {
-      return treeNodeMap[parentId].getChild(context);
-    }
-    auto id = nextContextId++;
-    treeNodeMap.try_emplace(id, id, parentId, context.name);
-    treeNodeMap[parentId].addChild(context, id);
+    ChildKey key{parentId, internName(context.name)};
+    auto [it, inserted] = childIds.try_emplace(key, treeNodes.size());
+    if (!inserted)
+      return it->second;
+    auto id = it->second;
+    // `treeNodes` may be reallocated, so nodes are accessed by id
+    treeNodes.emplace_back(id, parentId, context.name);
+    treeNodes[parentId].children.push_back(id);
     return id;
   }
 
-  size_t addNode(const std::vector<Context> &indices) {
-    auto parentId = TreeNode::RootId;
-    for (auto index : indices) {
+  size_t addNode(const std::vector<Context> &indices,
+                 size_t parentId = TreeNode::RootId) {
+    for (auto &index : indices) {
       parentId = addNode(index, parentId);
     }
     return parentId;
   }
 
-  TreeNode &getNode(size_t id) { return treeNodeMap.at(id); }
+  TreeNode &getNode(size_t id) { return treeNodes.at(id); }
 
   enum class WalkPolicy { PreOrder, PostOrder };
 
@@ -81,42 +86,162 @@ public:
 
   template <typename FnT> void walkPreOrder(size_t contextId, FnT &&fn) {
     fn(getNode(contextId));
-    for (auto &child : getNode(contextId).children) {
-      walkPreOrder(child.second, fn);
+    for (auto childId : getSortedChildren(contextId)) {
+      walkPreOrder(childId, fn);
     }
   }
 
+  /// Calls `enterFn` on a node before its children and `exitFn` after them.
+  template <typename EnterFnT, typename ExitFnT>
+  void walkPreOrder(size_t contextId, EnterFnT &&enterFn, ExitFnT &&exitFn) {
+    enterFn(getNode(contextId));
+    for (auto childId : getSortedChildren(contextId)) {
+      walkPreOrder(childId, enterFn, exitFn);
+    }
+    exitFn(getNode(contextId));
+  }
+
   template <typename FnT> void walkPostOrder(size_t contextId, FnT &&fn) {
-    for (auto &child : getNode(contextId).children) {
-      walkPostOrder(child.second, fn);
+    for (auto childId : getSortedChildren(contextId)) {
+      walkPostOrder(childId, fn);
     }
     fn(getNode(contextId));
   }
 
 private:
-  size_t nextContextId = TreeNode::RootId + 1;
+  struct ChildKey {
+    size_t parentId;
+    size_t nameId;
+
+    bool operator==(const ChildKey &other) const {
+      return parentId == other.parentId && nameId == other.nameId;
+    }
+  };
+
+  struct ChildKeyHash {
+    size_t operator()(const ChildKey &key) const {
+      return std::hash<size_t>()(key.parentId) ^
+             (std::hash<size_t>()(key.nameId) * 0x9E3779B97F4A7C15ull);
+    }
+  };
+
+  size_t internName(const std::string &name) {
+    return nameIds.try_emplace(name, nameIds.size()).first->second;
+  }
+
+  // Children are walked in the order of their names so that dumps are
+  // deterministic.
+  std::vector<size_t> getSortedChildren(size_t id) const {
+    auto children = treeNodes[id].children;
+    std::sort(children.begin(), children.end(), [&](size_t lhs, size_t rhs) {
+      return treeNodes[lhs].name < treeNodes[rhs].name;
+    });
+    return children;
+  }
+
   // tree node id -> tree node
-  std::map<size_t, TreeNode> treeNodeMap;
+  std::vector<TreeNode> treeNodes;
+  // (parent id, interned child name) -> child id
+  std::unordered_map<ChildKey, size_t, ChildKeyHash> childIds;
+  // context name -> interned name id
+  std::unordered_map<std::string, size_t> nameIds;
+};
+
+struct TreeData::ScopeUpdate {
+  size_t scopeId;
+  // The scope that an op is added under, or DummyScopeId if its contexts are
+  // rooted at the top of the tree
+  size_t parentScopeId;
+  std::vector<Context> contexts;
+};
+
+struct TreeData::MetricDeltas {
+  size_t scopeId;
+  Tree::MetricTable metrics = {};
+  std::map<std::string, FlexibleMetric> flexibleMetrics = {};
 };
 
+struct TreeData::ThreadBuffer {
+  std::mutex mutex;
+  // Set once the data is destroyed, so that threads drop the buffer
+  std::atomic<bool> released{false};
+  // Scopes and ops in the order they were added by the thread
+  std::vector<ScopeUpdate> scopeUpdates;
+  // Metrics added by the thread since the last merge. Consecutive metrics of
+  // the same scope are accumulated into one entry.
+  std::vector<MetricDeltas> metricDeltas;
+
+  MetricDeltas &getMetricDeltas(size_t scopeId) {
+    if (metricDeltas.empty() || metricDeltas.back().scopeId != scopeId)
+      metricDeltas.push_back({scopeId});
+    return metricDeltas.back();
+  }
+
+  size_t size() const { return scopeUpdates.size() + metricDeltas.size(); }
+};
+
+namespace {
+
+// A thread merges all buffered updates once its buffer reaches this size
+constexpr size_t MaxBufferedUpdates = 1024;
+
+std::atomic<size_t> nextDataId{0};
+
+} // namespace
+
 void TreeData::init() { tree = std::make_unique<Tree>(); }
 
+TreeData::ThreadBuffer &TreeData::getThreadBuffer() {
+  // Buffers are keyed by the id of the data rather than its address, which can
+  // be reused by another data once this one is destroyed.
+  static thread_local std::unordered_map<size_t, std::shared_ptr<ThreadBuffer>>
+      buffers;
+  static thread_local std::pair<size_t, ThreadBuffer *> lastBuffer{
+      std::numeric_limits<size_t>::max(), nullptr};
+  if (lastBuffer.first == dataId)
+    return *lastBuffer.second;
+  auto it = buffers.find(dataId);
+  if (it == buffers.end()) {
+    // Drop the buffers of destroyed data before adding one
+    for (auto jt = buffers.begin(); jt != buffers.end();) {
+      if (jt->second->released.load(std::memory_order_relaxed))
+        jt = buffers.erase(jt);
+      else
+        ++jt;
+    }
+    it = buffers.emplace(dataId, std::make_shared<ThreadBuffer>()).first;
+    std::lock_guard<std::mutex> lock(threadBuffersMutex);
+    threadBuffers.push_back(it->second);
+  }
+  lastBuffer = {dataId, it->second.get()};
+  return *it->second;
+}
+
+void TreeData::flushIfFull(ThreadBuffer &buffer,
+                           std::unique_lock<std::mutex> &bufferLock) {
+  if (buffer.size() < MaxBufferedUpdates)
+    return;
+  bufferLock.unlock();
+  flush();
+}
+
 void TreeData::enterScope(const Scope &scope) {
-  // enterOp and addMetric maybe called from different threads
-  std::unique_lock<std::shared_mutex> lock(mutex);
   std::vector<Context> contexts;
   if (contextSource != nullptr)
     contexts = contextSource->getContexts();
-  auto contextId = tree->addNode(contexts);
-  scopeIdToContextId[scope.scopeId] = contextId;
+  scopeIds.insert(scope.scopeId);
+  auto &buffer = getThreadBuffer();
+  std::unique_lock<std::mutex> lock(buffer.mutex);
+  buffer.scopeUpdates.push_back(
+      {scope.scopeId, Scope::DummyScopeId, std::move(contexts)});
+  flushIfFull(buffer, lock);
 }
 
 void TreeData::exitScope(const Scope &scope) {}
 
 size_t TreeData::addOp(size_t scopeId, const std::string &name) {
-  std::unique_lock<std::shared_mutex> lock(mutex);
-  auto scopeIdIt = scopeIdToContextId.find(scopeId);
-  if (scopeIdIt == scopeIdToContextId.end()) {
+  auto &buffer = getThreadBuffer();
+  if (scopeIds.insert(scopeId)) {
     // Obtain the current context
     std::vector<Context> contexts;
     if (contextSource != nullptr)
@@ -124,176 +249,355 @@ size_t TreeData::addOp(size_t scopeId, const std::string &name) {
     // Add an op under the current context
     if (!name.empty())
       contexts.emplace_back(name);
-    scopeIdToContextId[scopeId] = tree->addNode(contexts);
-  } else {
-    // Add a new context under it and update the context
-    scopeId = Scope::getNewScopeId();
-    scopeIdToContextId[scopeId] =
-        tree->addNode(Context(name), scopeIdIt->second);
+    std::unique_lock<std::mutex> lock(buffer.mutex);
+    buffer.scopeUpdates.push_back(
+        {scopeId, Scope::DummyScopeId, std::move(contexts)});
+    flushIfFull(buffer, lock);
+    return scopeId;
   }
-  return scopeId;
+  // Add a new context under it and update the context
+  auto newScopeId = Scope::getNewScopeId();
+  scopeIds.insert(newScopeId);
+  std::unique_lock<std::mutex> lock(buffer.mutex);
+  buffer.scopeUpdates.push_back({newScopeId, scopeId, {Context(name)}});
+  flushIfFull(buffer, lock);
+  return newScopeId;
 }
 
+// Metrics are accumulated in the calling thread's buffer. A metric is added
+// after its scope has been buffered, so the scope is collected no later than
+// the metric.
 void TreeData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
-  std::unique_lock<std::shared_mutex> lock(mutex);
-  auto scopeIdIt = scopeIdToContextId.find(scopeId);
   // The profile data is deactivated, ignore the metric
-  if (scopeIdIt == scopeIdToContextId.end())
+  if (!scopeIds.contain(scopeId))
     return;
-  auto contextId = scopeIdIt->second;
-  auto &node = tree->getNode(contextId);
-  if (node.metrics.find(metric->getKind()) == node.metrics.end())
-    node.metrics.emplace(metric->getKind(), metric);
+  auto &buffer = getThreadBuffer();
+  std::unique_lock<std::mutex> lock(buffer.mutex);
+  auto &deltas = buffer.getMetricDeltas(scopeId);
+  auto &deltaMetric = deltas.metrics[static_cast<size_t>(metric->getKind())];
+  if (!deltaMetric)
+    deltaMetric = metric;
   else
-    node.metrics[metric->getKind()]->updateMetric(*metric);
+    deltaMetric->updateMetric(*metric);
+  flushIfFull(buffer, lock);
 }
 
 void TreeData::addMetrics(
     size_t scopeId, const std::map<std::string, MetricValueType> &metrics) {
-  std::unique_lock<std::shared_mutex> lock(mutex);
-  auto scopeIdIt = scopeIdToContextId.find(scopeId);
   // The profile data is deactivated, ignore the metric
-  if (scopeIdIt == scopeIdToContextId.end())
+  if (!scopeIds.contain(scopeId))
     return;
-  auto contextId = scopeIdIt->second;
-  auto &node = tree->getNode(contextId);
+  auto &buffer = getThreadBuffer();
+  std::unique_lock<std::mutex> lock(buffer.mutex);
+  auto &deltas = buffer.getMetricDeltas(scopeId);
   for (auto [metricName, metricValue] : metrics) {
-    if (node.flexibleMetrics.find(metricName) == node.flexibleMetrics.end()) {
-      node.flexibleMetrics.emplace(metricName,
-                                   FlexibleMetric(metricName, metricValue));
+    auto it = deltas.flexibleMetrics.find(metricName);
+    if (it == deltas.flexibleMetrics.end()) {
+      deltas.flexibleMetrics.emplace(metricName,
+                                     FlexibleMetric(metricName, metricValue));
     } else {
-      node.flexibleMetrics.at(metricName).updateValue(metricValue);
+      it->second.updateValue(metricValue);
+    }
+  }
+  flushIfFull(buffer, lock);
+}
+
+bool TreeData::applyScopeUpdate(const ScopeUpdate &update) {
+  auto parentContextId = Tree::TreeNode::RootId;
+  if (update.parentScopeId != Scope::DummyScopeId) {
+    auto parentIt = scopeIdToContextId.find(update.parentScopeId);
+    if (parentIt == scopeIdToContextId.end())
+      return false;
+    parentContextId = parentIt->second;
+  }
+  scopeIdToContextId[update.scopeId] =
+      tree->addNode(update.contexts, parentContextId);
+  return true;
+}
+
+bool TreeData::applyMetricDeltas(MetricDeltas &deltas) {
+  auto scopeIdIt = scopeIdToContextId.find(deltas.scopeId);
+  if (scopeIdIt == scopeIdToContextId.end())
+    return false;
+  auto &node = tree->getNode(scopeIdIt->second);
+  for (auto &metric : deltas.metrics) {
+    if (!metric)
+      continue;
+    auto &nodeMetric = node.getMetric(metric->getKind());
+    if (!nodeMetric)
+      nodeMetric = metric;
+    else
+      nodeMetric->updateMetric(*metric);
+  }
+  for (auto &[metricName, flexibleMetric] : deltas.flexibleMetrics) {
+    auto it = node.flexibleMetrics.find(metricName);
+    if (it == node.flexibleMetrics.end())
+      node.flexibleMetrics.emplace(metricName, flexibleMetric);
+    else
+      it->second.updateMetric(flexibleMetric);
+  }
+  return true;
+}
+
+void TreeData::mergeThreadBuffers(bool clearScopes) {
+  // Updates deferred by the last merge are applied first
+  auto scopeUpdates = std::move(deferredScopeUpdates);
+  auto metricDeltas = std::move(deferredMetricDeltas);
+  deferredScopeUpdates.clear();
+  deferredMetricDeltas.clear();
+  {
+    std::lock_guard<std::mutex> lock(threadBuffersMutex);
+    // All buffers are locked at once, so that a metric is collected along
+    // with the scope or op it was added to.
+    std::vector<std::unique_lock<std::mutex>> bufferLocks;
+    for (auto &buffer : threadBuffers)
+      bufferLocks.emplace_back(buffer->mutex);
+    // A buffer that is only referenced here belongs to a thread that has
+    // exited, and is released once it has been collected.
+    std::vector<bool> isReleased;
+    for (auto &buffer : threadBuffers) {
+      std::move(buffer->scopeUpdates.begin(), buffer->scopeUpdates.end(),
+                std::back_inserter(scopeUpdates));
+      buffer->scopeUpdates.clear();
+      std::move(buffer->metricDeltas.begin(), buffer->metricDeltas.end(),
+                std::back_inserter(metricDeltas));
+      buffer->metricDeltas.clear();
+      isReleased.push_back(buffer.use_count() == 1);
+    }
+    if (clearScopes)
+      scopeIds.clear();
+    bufferLocks.clear();
+    size_t numBuffers = 0;
+    for (size_t i = 0; i < threadBuffers.size(); ++i) {
+      if (!isReleased[i])
+        threadBuffers[numBuffers++] = std::move(threadBuffers[i]);
+    }
+    threadBuffers.resize(numBuffers);
+  }
+  // Each thread's scopes are added in order. An op added under a scope of
+  // another thread may come first and is retried.
+  while (!scopeUpdates.empty()) {
+    std::vector<ScopeUpdate> retriedUpdates;
+    for (auto &update : scopeUpdates) {
+      if (!applyScopeUpdate(update))
+        retriedUpdates.push_back(std::move(update));
     }
+    if (retriedUpdates.size() == scopeUpdates.size())
+      break;
+    scopeUpdates = std::move(retriedUpdates);
   }
+  // A scope is known to other threads before it is buffered, so an op can be
+  // added under it and collected first. Such ops, and their metrics, are
+  // merged along with the scope. The metrics of other missing scopes are
+  // ignored, as the profile data has been deactivated.
+  std::unordered_set<size_t> deferredScopeIds;
+  if (!clearScopes) {
+    for (auto &update : scopeUpdates)
+      deferredScopeIds.insert(update.scopeId);
+    deferredScopeUpdates = std::move(scopeUpdates);
+  }
+  for (auto &deltas : metricDeltas) {
+    if (!applyMetricDeltas(deltas) && deferredScopeIds.count(deltas.scopeId))
+      deferredMetricDeltas.push_back(std::move(deltas));
+  }
+  if (clearScopes)
+    scopeIdToContextId.clear();
+}
+
+void TreeData::flush() {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  mergeThreadBuffers(/*clearScopes=*/false);
 }
 
 void TreeData::clear() {
   std::unique_lock<std::shared_mutex> lock(mutex);
-  scopeIdToContextId.clear();
+  // Metrics added before the data is deactivated are kept
+  mergeThreadBuffers(/*clearScopes=*/true);
 }
 
-void TreeData::dumpHatchet(std::ostream &os) const {
-  std::map<size_t, json *> jsonNodes;
-  json output = json::array();
-  output.push_back(json::object());
-  jsonNodes[Tree::TreeNode::RootId] = &(output.back());
+namespace {
+
+// Returns the metrics of a node in the hatchet format, keyed by value name.
+template <typename MetricTable, typename FlexibleMetricMap>
+std::map<std::string, json>
+getHatchetMetrics(const MetricTable &metrics,
+                  const FlexibleMetricMap &flexibleMetrics) {
+  std::map<std::string, json> values;
+  for (auto &metric : metrics) {
+    if (!metric)
+      continue;
+    auto metricKind = metric->getKind();
+    if (metricKind == MetricKind::Kernel) {
+      std::shared_ptr<KernelMetric> kernelMetric =
+          std::dynamic_pointer_cast<KernelMetric>(metric);
+      uint64_t duration =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::Duration));
+      uint64_t invocations = std::get<uint64_t>(
+          kernelMetric->getValue(KernelMetric::Invocations));
+      uint64_t deviceId =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceId));
+      uint64_t deviceType =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceType));
+      values[kernelMetric->getValueName(KernelMetric::Duration)] = duration;
+      values[kernelMetric->getValueName(KernelMetric::Invocations)] =
+          invocations;
+      values[kernelMetric->getValueName(KernelMetric::DeviceId)] =
+          std::to_string(deviceId);
+      values[kernelMetric->getValueName(KernelMetric::DeviceType)] =
+          getDeviceTypeString(static_cast<DeviceType>(deviceType));
+    } else if (metricKind == MetricKind::PCSampling) {
+      auto pcSamplingMetric =
+          std::dynamic_pointer_cast<PCSamplingMetric>(metric);
+      for (size_t i = 0; i < PCSamplingMetric::Count; i++) {
+        std::visit(
+            [&](auto &&value) {
+              values[pcSamplingMetric->getValueName(i)] = value;
+            },
+            pcSamplingMetric->getValues()[i]);
+      }
+    } else {
+      throw std::runtime_error("MetricKind not supported");
+    }
+  }
+  for (auto [_, flexibleMetric] : flexibleMetrics) {
+    std::visit(
+        [&](auto &&value) { values[flexibleMetric.getValueName(0)] = value; },
+        flexibleMetric.getValues()[0]);
+  }
+  return values;
+}
+
+} // namespace
+
+void TreeData::dumpHatchet(std::ostream &os, bool compact) const {
+  // The tree is written to the stream while it is walked, so that the memory
+  // used by the dump doesn't grow with the size of the tree. A first pass
+  // collects the information that has to be written before the nodes.
   std::set<std::string> inclusiveValueNames;
   std::map<uint64_t, std::set<uint64_t>> deviceIds;
   this->tree->template walk<Tree::WalkPolicy::PreOrder>(
       [&](Tree::TreeNode &treeNode) {
-        const auto contextName = treeNode.name;
-        auto contextId = treeNode.id;
-        json *jsonNode = jsonNodes[contextId];
-        (*jsonNode)["frame"] = {{"name", contextName}, {"type", "function"}};
-        (*jsonNode)["metrics"] = json::object();
-        for (auto [metricKind, metric] : treeNode.metrics) {
+        for (auto &metric : treeNode.metrics) {
+          if (!metric)
+            continue;
+          auto metricKind = metric->getKind();
           if (metricKind == MetricKind::Kernel) {
             std::shared_ptr<KernelMetric> kernelMetric =
                 std::dynamic_pointer_cast<KernelMetric>(metric);
-            uint64_t duration = std::get<uint64_t>(
-                kernelMetric->getValue(KernelMetric::Duration));
-            uint64_t invocations = std::get<uint64_t>(
-                kernelMetric->getValue(KernelMetric::Invocations));
             uint64_t deviceId = std::get<uint64_t>(
                 kernelMetric->getValue(KernelMetric::DeviceId));
             uint64_t deviceType = std::get<uint64_t>(
                 kernelMetric->getValue(KernelMetric::DeviceType));
-            std::string deviceTypeName =
-                getDeviceTypeString(static_cast<DeviceType>(deviceType));
-            (*jsonNode)["metrics"]
-                       [kernelMetric->getValueName(KernelMetric::Duration)] =
-                           duration;
-            (*jsonNode)["metrics"]
-                       [kernelMetric->getValueName(KernelMetric::Invocations)] =
-                           invocations;
-            (*jsonNode)["metrics"]
-                       [kernelMetric->getValueName(KernelMetric::DeviceId)] =
-                           std::to_string(deviceId);
-            (*jsonNode)["metrics"]
-                       [kernelMetric->getValueName(KernelMetric::DeviceType)] =
-                           deviceTypeName;
             inclusiveValueNames.insert(
                 kernelMetric->getValueName(KernelMetric::Duration));
             inclusiveValueNames.insert(
                 kernelMetric->getValueName(KernelMetric::Invocations));
-            deviceIds.insert({deviceType, {deviceId}});
+            deviceIds[deviceType].insert(deviceId);
           } else if (metricKind == MetricKind::PCSampling) {
-            auto pcSamplingMetric =
-                std::dynamic_pointer_cast<PCSamplingMetric>(metric);
             for (size_t i = 0; i < PCSamplingMetric::Count; i++) {
-              auto valueName = pcSamplingMetric->getValueName(i);
-              inclusiveValueNames.insert(valueName);
-              std::visit(
-                  [&](auto &&value) {
-                    (*jsonNode)["metrics"][valueName] = value;
-                  },
-                  pcSamplingMetric->getValues()[i]);
+              inclusiveValueNames.insert(metric->getValueName(i));
             }
-          } else {
-            throw std::runtime_error("MetricKind not supported");
           }
         }
         for (auto [_, flexibleMetric] : treeNode.flexibleMetrics) {
-          auto valueName = flexibleMetric.getValueName(0);
           if (!flexibleMetric.isExclusive(0))
-            inclusiveValueNames.insert(valueName);
-          std::visit(
-              [&](auto &&value) { (*jsonNode)["metrics"][valueName] = value; },
-              flexibleMetric.getValues()[0]);
+            inclusiveValueNames.insert(flexibleMetric.getValueName(0));
         }
-        (*jsonNode)["children"] = json::array();
-        auto children = treeNode.children;
-        for (auto _ : children) {
-          (*jsonNode)["children"].push_back(json::object());
+      });
+
+  os << std::endl;
+  JsonWriter writer(os, compact ? -1 : 4);
+  writer.beginArray();
+  this->tree->walkPreOrder(
+      Tree::TreeNode::RootId,
+      [&](Tree::TreeNode &treeNode) {
+        auto metrics =
+            getHatchetMetrics(treeNode.metrics, treeNode.flexibleMetrics);
+        if (treeNode.id == Tree::TreeNode::RootId) {
+          // Hints for all inclusive metrics
+          for (auto &valueName : inclusiveValueNames) {
+            metrics[valueName] = 0;
+          }
         }
-        auto idx = 0;
-        for (auto child : children) {
-          auto [index, childId] = child;
-          jsonNodes[childId] = &(*jsonNode)["children"][idx];
-          idx++;
+        writer.beginObject();
+        writer.key("frame");
+        writer.beginObject();
+        writer.key("name");
+        writer.value(treeNode.name);
+        writer.key("type");
+        writer.value("function");
+        writer.endObject();
+        writer.key("metrics");
+        writer.beginObject();
+        for (auto &[valueName, value] : metrics) {
+          writer.key(valueName);
+          writer.value(value);
         }
+        writer.endObject();
+        writer.key("children");
+        writer.beginArray();
+      },
+      [&](Tree::TreeNode &treeNode) {
+        writer.endArray();
+        writer.endObject();
       });
-  // Hints for all inclusive metrics
-  for (auto valueName : inclusiveValueNames) {
-    output[Tree::TreeNode::RootId]["metrics"][valueName] = 0;
-  }
   // Prepare the device information
   // Note that this is done from the application thread,
   // query device information from the tool thread (e.g., CUPTI) will have
   // problems
-  output.push_back(json::object());
-  auto &deviceJson = output.back();
-  for (auto [deviceType, deviceIds] : deviceIds) {
-    auto deviceTypeName =
-        getDeviceTypeString(static_cast<DeviceType>(deviceType));
-    if (!deviceJson.contains(deviceTypeName))
-      deviceJson[deviceTypeName] = json::object();
+  writer.beginObject();
+  for (auto &[deviceType, deviceIds] : deviceIds) {
+    writer.key(getDeviceTypeString(static_cast<DeviceType>(deviceType)));
+    writer.beginObject();
     for (auto deviceId : deviceIds) {
       Device device = getDevice(static_cast<DeviceType>(deviceType), deviceId);
-      deviceJson[deviceTypeName][std::to_string(deviceId)] = {
-          {"clock_rate", device.clockRate},
-          {"memory_clock_rate", device.memoryClockRate},
-          {"bus_width", device.busWidth},
-          {"arch", device.arch},
-          {"num_sms", device.numSms}};
+      writer.key(std::to_string(deviceId));
+      writer.beginObject();
+      writer.key("arch");
+      writer.value(device.arch);
+      writer.key("bus_width");
+      writer.value(device.busWidth);
+      writer.key("clock_rate");
+      writer.value(device.clockRate);
+      writer.key("memory_clock_rate");
+      writer.value(device.memoryClockRate);
+      writer.key("num_sms");
+      writer.value(device.numSms);
+      writer.endObject();
     }
+    writer.endObject();
   }
-  os << std::endl << output.dump(4) << std::endl;
+  writer.endObject();
+  writer.endArray();
+  os << std::endl;
 }
 
 void TreeData::doDump(std::ostream &os, OutputFormat outputFormat) const {
   if (outputFormat == OutputFormat::Hatchet) {
-    dumpHatchet(os);
+    dumpHatchet(os, /*compact=*/false);
+  } else if (outputFormat == OutputFormat::HatchetCompact) {
+    dumpHatchet(os, /*compact=*/true);
   } else {
-    std::logic_error("OutputFormat not supported");
+    throw std::logic_error("OutputFormat not supported");
   }
 }
 
 TreeData::TreeData(const std::string &path, ContextSource *contextSource)
-    : Data(path, contextSource) {
+    : Data(path, contextSource), dataId(nextDataId++) {
   init();
 }
 
-TreeData::~TreeData() {}
+TreeData::~TreeData() {
+  // Other threads only drop their buffers of this data when they add a buffer
+  // or exit, so the buffered updates are released here.
+  std::lock_guard<std::mutex> lock(threadBuffersMutex);
+  for (auto &buffer : threadBuffers) {
+    std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+    buffer->scopeUpdates = {};
+    buffer->metricDeltas = {};
+    buffer->released.store(true, std::memory_order_relaxed);
+  }
+  threadBuffers.clear();
+}
 
 } // namespace proton
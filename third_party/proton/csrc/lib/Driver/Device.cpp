@@ -1,6 +1,8 @@
 #include "Driver/Device.h"
 #include "Driver/GPU/CudaApi.h"
+#include "Driver/GPU/CuptiApi.h"
 #include "Driver/GPU/HipApi.h"
+#include "Driver/GPU/RoctracerApi.h"
 
 #include "Utility/Errors.h"
 
@@ -25,4 +27,18 @@ const std::string getDeviceTypeString(DeviceType type) {
   throw std::runtime_error("DeviceType not supported");
 }
 
+uint64_t getDeviceTimestamp(DeviceType type) {
+  if (type == DeviceType::CUDA) {
+    uint64_t timestamp = 0;
+    cupti::getTimestamp<true>(&timestamp);
+    return timestamp;
+  }
+  if (type == DeviceType::HIP) {
+    roctracer_timestamp_t timestamp = 0;
+    roctracer::getTimestamp<true>(&timestamp);
+    return timestamp;
+  }
+  throw std::runtime_error("DeviceType not supported");
+}
+
 } // namespace proton
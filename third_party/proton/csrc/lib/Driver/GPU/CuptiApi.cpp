@@ -18,6 +18,8 @@ void *ExternLibCupti::lib = nullptr;
 
 DEFINE_DISPATCH(ExternLibCupti, getVersion, cuptiGetVersion, uint32_t *);
 
+DEFINE_DISPATCH(ExternLibCupti, getTimestamp, cuptiGetTimestamp, uint64_t *);
+
 DEFINE_DISPATCH(ExternLibCupti, getContextId, cuptiGetContextId, CUcontext,
                 uint32_t *);
 
@@ -72,7 +72,9 @@ def start(
                                  Available options are ["shadow", "python"].
                                  Defaults to "shadow".
         data (str, optional): The data structure to use for profiling.
-                              Available options are ["tree"].
+                              Available options are ["tree", "trace"].
+                              "tree" aggregates metrics per calling context and is dumped as "hatchet".
+                              "trace" records every scope and kernel on a timeline and is dumped as "chrome_trace".
                               Defaults to "tree".
         hook (str, optional): The hook to use for profiling.
                               Available options are [None, "triton"].
@@ -146,7 +148,8 @@ def finalize(session: Optional[int] = None, output_format: str = "hatchet") -> N
     Args:
         session (int, optional): The session ID to finalize. If None, all sessions are finalized. Defaults to None.
         output_format (str, optional): The output format for the profiling results.
-                                       Aavailable options are ["hatchet"].
+                                       Available options are ["hatchet", "hatchet_compact", "chrome_trace"].
+                                       "hatchet_compact" writes the same profile as "hatchet" without indentation.
 
     Returns:
         None
@@ -0,0 +1,80 @@
+"""
+Measures the time and peak memory of dumping a large hatchet profile.
+
+A synthetic tree with `--outer` x `--inner` nodes is built through the proton
+API, then finalized in each requested output format. Every format runs in its
+own process so that the peak RSS of one dump doesn't hide the other.
+
+Usage: python bench_hatchet_dump.py [--outer 1000] [--inner 1000] [--formats hatchet hatchet_compact]
+"""
+
+import argparse
+import json
+import os
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def get_peak_rss_mb():
+    # ru_maxrss is reported in KB on Linux
+    return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024
+
+
+def run_dump(output_format, outer, inner, path):
+    import triton._C.libproton.proton as libproton
+    from triton.profiler.profile import _select_backend
+
+    session_id = libproton.start(path, "shadow", "tree", _select_backend(), "")
+    for i in range(outer):
+        libproton.enter_state(f"outer_{i}")
+        for j in range(inner):
+            scope_id = libproton.record_scope()
+            libproton.enter_scope(scope_id, f"inner_{j}")
+            libproton.add_metrics(scope_id, {"flops": float(j), "bytes": j})
+            libproton.exit_scope(scope_id, f"inner_{j}")
+        libproton.exit_state()
+    rss_before = get_peak_rss_mb()
+    start = time.perf_counter()
+    libproton.finalize(session_id, output_format)
+    elapsed = time.perf_counter() - start
+    rss_after = get_peak_rss_mb()
+    size = os.path.getsize(path + ".hatchet")
+    print(json.dumps({
+        "format": output_format, "dump_s": elapsed, "peak_rss_before_mb": rss_before, "peak_rss_after_mb": rss_after,
+        "file_mb": size / 2**20
+    }))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--outer", type=int, default=1000)
+    parser.add_argument("--inner", type=int, default=1000)
+    parser.add_argument("--formats", type=str, nargs="+", default=["hatchet", "hatchet_compact"])
+    parser.add_argument("--worker", type=str, default=None, help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.worker:
+        output_format, path = args.worker.split(":", 1)
+        run_dump(output_format, args.outer, args.inner, path)
+        return
+
+    print(f"{'format':<18}{'nodes':>10}{'dump (s)':>12}{'dump peak RSS (MB)':>22}{'file (MB)':>12}")
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for output_format in args.formats:
+            path = os.path.join(tmp_dir, output_format)
+            result = subprocess.run([
+                sys.executable, __file__, "--outer",
+                str(args.outer), "--inner",
+                str(args.inner), "--worker", f"{output_format}:{path}"
+            ], check=True, capture_output=True, text=True)
+            stats = json.loads(result.stdout.strip().splitlines()[-1])
+            dump_rss = stats["peak_rss_after_mb"] - stats["peak_rss_before_mb"]
+            print(f"{output_format:<18}{args.outer * args.inner:>10}{stats['dump_s']:>12.2f}{dump_rss:>22.1f}"
+                  f"{stats['file_mb']:>12.1f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+// CPU-only microbenchmarks of the profiling overhead of Proton's Data
+// backends. Scopes and metrics are synthesized, so no GPU is required.
+
+#include "Context/Shadow.h"
+#include "Data/Metric.h"
+#include "Data/TraceData.h"
+#include "Data/TreeData.h"
+
+#include "benchmark/benchmark.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace proton;
+
+namespace {
+
+std::vector<std::string> makeNames(size_t count) {
+  std::vector<std::string> names;
+  for (size_t i = 0; i < count; ++i)
+    names.push_back("scope_" + std::to_string(i));
+  return names;
+}
+
+// Enters `depth` scopes that stay open for the duration of a benchmark.
+std::vector<Scope> enterParentScopes(ScopeInterface &contextSource,
+                                     ScopeInterface &data, size_t depth) {
+  std::vector<Scope> scopes;
+  for (size_t i = 0; i < depth; ++i) {
+    scopes.emplace_back(Scope::getNewScopeId(), "parent_" + std::to_string(i));
+    contextSource.enterScope(scopes.back());
+    data.enterScope(scopes.back());
+  }
+  return scopes;
+}
+
+void exitParentScopes(ScopeInterface &contextSource, ScopeInterface &data,
+                      const std::vector<Scope> &scopes) {
+  for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+    data.exitScope(*it);
+    contextSource.exitScope(*it);
+  }
+}
+
+// Args: {number of distinct scope names, depth of the enclosing scopes}
+template <typename DataT> void BM_EnterScope(benchmark::State &state) {
+  ShadowContextSource contextSource;
+  DataT data("", &contextSource);
+  ScopeInterface &contextScopes = contextSource;
+  ScopeInterface &dataScopes = data;
+  auto names = makeNames(state.range(0));
+  auto parents = enterParentScopes(contextScopes, dataScopes, state.range(1));
+  size_t i = 0;
+  for (auto _ : state) {
+    Scope scope(Scope::getNewScopeId(), names[i++ % names.size()]);
+    contextScopes.enterScope(scope);
+    dataScopes.enterScope(scope);
+    dataScopes.exitScope(scope);
+    contextScopes.exitScope(scope);
+  }
+  exitParentScopes(contextScopes, dataScopes, parents);
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Args: {number of flexible metrics per call}
+template <typename DataT> void BM_AddMetrics(benchmark::State &state) {
+  ShadowContextSource contextSource;
+  DataT data("", &contextSource);
+  ScopeInterface &contextScopes = contextSource;
+  ScopeInterface &dataScopes = data;
+  Scope scope(Scope::getNewScopeId(), "scope");
+  contextScopes.enterScope(scope);
+  dataScopes.enterScope(scope);
+  std::map<std::string, MetricValueType> metrics;
+  for (auto &name : makeNames(state.range(0)))
+    metrics[name] = 1.0;
+  for (auto _ : state) {
+    data.addMetrics(scope.scopeId, metrics);
+  }
+  dataScopes.exitScope(scope);
+  contextScopes.exitScope(scope);
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Records a kernel launch and its kernel metric, as GPU profilers do.
+// Args: {number of distinct kernel names}
+template <typename DataT> void BM_AddOpAndMetric(benchmark::State &state) {
+  ShadowContextSource contextSource;
+  DataT data("", &contextSource);
+  auto names = makeNames(state.range(0));
+  size_t i = 0;
+  for (auto _ : state) {
+    auto scopeId =
+        data.addOp(Scope::getNewScopeId(), names[i++ % names.size()]);
+    data.addMetric(scopeId, std::make_shared<KernelMetric>(
+                                /*startTime=*/0, /*endTime=*/1000,
+                                /*invocations=*/1, /*deviceId=*/0,
+                                /*deviceType=*/0));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Launches kernels from several threads while the same threads report kernel
+// metrics, as the launcher threads and the profiler callback thread do.
+// Args: {number of distinct kernel names}
+template <typename DataT>
+void BM_ConcurrentAddOpAndMetric(benchmark::State &state) {
+  static std::unique_ptr<ShadowContextSource> contextSource;
+  static std::unique_ptr<DataT> data;
+  if (state.thread_index() == 0) {
+    contextSource = std::make_unique<ShadowContextSource>();
+    data = std::make_unique<DataT>("", contextSource.get());
+  }
+  auto names = makeNames(state.range(0));
+  size_t i = state.thread_index();
+  for (auto _ : state) {
+    // The op of the launch, and the kernel attributed to it
+    auto opScopeId = Scope::getNewScopeId();
+    data->addOp(opScopeId, names[i++ % names.size()]);
+    auto kernelScopeId = data->addOp(opScopeId, "kernel");
+    data->addMetric(kernelScopeId, std::make_shared<KernelMetric>(
+                                       /*startTime=*/0, /*endTime=*/1000,
+                                       /*invocations=*/1, /*deviceId=*/0,
+                                       /*deviceType=*/0));
+  }
+  if (state.thread_index() == 0) {
+    data->flush();
+    data.reset();
+    contextSource.reset();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_EnterScope, TreeData)
+    ->ArgsProduct({{1, 64, 4096}, {0, 8}});
+BENCHMARK_TEMPLATE(BM_EnterScope, TraceData)->ArgsProduct({{64}, {0, 8}});
+BENCHMARK_TEMPLATE(BM_AddMetrics, TreeData)->Arg(1)->Arg(8);
+BENCHMARK_TEMPLATE(BM_AddMetrics, TraceData)->Arg(1)->Arg(8);
+BENCHMARK_TEMPLATE(BM_AddOpAndMetric, TreeData)->Arg(1)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_AddOpAndMetric, TraceData)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_ConcurrentAddOpAndMetric, TreeData)
+    ->Arg(1024)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentAddOpAndMetric, TraceData)
+    ->Arg(1024)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
@@ -1,4 +1,6 @@
+import json
 import pathlib
+import threading
 
 import triton._C.libproton.proton as libproton
 from triton.profiler.profile import _select_backend
@@ -49,3 +51,66 @@ def test_add_metrics(tmp_path: pathlib.Path):
     libproton.exit_scope(id1, "one")
     libproton.finalize_all("hatchet")
     assert temp_file.exists()
+
+
+def test_hatchet_compact(tmp_path: pathlib.Path):
+    temp_file = tmp_path / "test_hatchet_compact.hatchet"
+    session_id = libproton.start(str(temp_file.with_suffix("")), "shadow", "tree", _select_backend(), "")
+    id1 = libproton.record_scope()
+    libproton.enter_scope(id1, "one")
+    libproton.add_metrics(id1, {"a": 1.0})
+    libproton.exit_scope(id1, "one")
+    libproton.finalize(session_id, "hatchet_compact")
+    with temp_file.open() as f:
+        content = f.read()
+    assert "\n    " not in content
+    root = json.loads(content)[0]
+    assert root["metrics"]["a"] == 0
+    assert root["children"][0]["frame"]["name"] == "one"
+    assert root["children"][0]["metrics"]["a"] == 1.0
+
+
+def test_trace_data(tmp_path: pathlib.Path):
+    temp_file = tmp_path / "test_trace_data.chrome_trace"
+    session_id = libproton.start(str(temp_file.with_suffix("")), "shadow", "trace", _select_backend(), "")
+    id0 = libproton.record_scope()
+    libproton.enter_scope(id0, "zero")
+    id1 = libproton.record_scope()
+    libproton.enter_scope(id1, "one")
+    libproton.add_metrics(id1, {"a": 1.0})
+    libproton.exit_scope(id1, "one")
+    libproton.exit_scope(id0, "zero")
+    libproton.finalize(session_id, "chrome_trace")
+    assert temp_file.exists()
+    with temp_file.open() as f:
+        events = [event for event in json.load(f)["traceEvents"] if event["ph"] == "X"]
+    assert [event["name"] for event in events] == ["zero", "one"]
+    zero, one = events
+    assert zero["ts"] <= one["ts"]
+    assert one["ts"] + one["dur"] <= zero["ts"] + zero["dur"]
+    assert one["args"]["a"] == 1.0
+
+
+def test_tree_data_threads(tmp_path: pathlib.Path):
+    # Each thread buffers its own updates, which are merged into one tree
+    temp_file = tmp_path / "test_tree_data_threads.hatchet"
+    session_id = libproton.start(str(temp_file.with_suffix("")), "shadow", "tree", _select_backend(), "")
+    num_threads, num_scopes = 8, 500
+
+    def record(name):
+        for _ in range(num_scopes):
+            scope_id = libproton.record_scope()
+            libproton.enter_scope(scope_id, name)
+            libproton.add_metrics(scope_id, {"a": 1.0})
+            libproton.exit_scope(scope_id, name)
+
+    threads = [threading.Thread(target=record, args=(f"thread{i}", )) for i in range(num_threads)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    libproton.finalize(session_id, "hatchet")
+    with temp_file.open() as f:
+        root = json.load(f)[0]
+    metrics = {child["frame"]["name"]: child["metrics"]["a"] for child in root["children"]}
+    assert metrics == {f"thread{i}": num_scopes for i in range(num_threads)}
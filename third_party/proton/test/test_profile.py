@@ -311,3 +311,19 @@ def test_multiple_sessions(tmp_path: pathlib.Path):
     with temp_file1.open() as f:
         data = json.load(f)
     assert int(data[0]["children"][0]["metrics"]["count"]) == 3
+
+
+def test_trace_kernel_timestamps(tmp_path: pathlib.Path):
+    temp_file = tmp_path / "test_trace_kernel_timestamps.chrome_trace"
+    proton.start(str(temp_file.with_suffix("")), data="trace")
+    with proton.scope("test"):
+        torch.ones((2, 2), device="cuda")
+        torch.cuda.synchronize()
+    proton.finalize(output_format="chrome_trace")
+    with temp_file.open() as f:
+        events = json.load(f)["traceEvents"]
+    scope = next(event for event in events if event.get("cat") == "scope")
+    kernel = next(event for event in events if event.get("cat") == "kernel")
+    # Kernels are moved to the host clock, so the kernel runs within the scope.
+    assert scope["ts"] <= kernel["ts"] + 1
+    assert kernel["ts"] + kernel["dur"] <= scope["ts"] + scope["dur"] + 1
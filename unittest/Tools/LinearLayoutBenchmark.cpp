@@ -0,0 +1,111 @@
+// CPU microbenchmarks of the LinearLayout operations that run on every layout
+// conversion during compilation.  Layouts are random, with the shapes of a
+// distributed layout (register, lane, warp, block -> dim0, dim1) and of a
+// shared memory layout (dim0, dim1 -> offset).
+
+#include "triton/Tools/LinearLayout.h"
+
+#include "mlir/IR/MLIRContext.h"
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <vector>
+
+using namespace mlir;
+using namespace mlir::triton;
+
+namespace {
+
+MLIRContext &getContext() {
+  static MLIRContext ctx;
+  return ctx;
+}
+
+StringAttr S(StringRef str) { return StringAttr::get(&getContext(), str); }
+
+// Returns a layout whose bases are uniformly random values in the out-dims.
+LinearLayout randomLayout(std::mt19937 &rng,
+                          ArrayRef<std::pair<StringRef, int32_t>> inDims,
+                          ArrayRef<std::pair<StringRef, int32_t>> outDims) {
+  LinearLayout::BasesT bases;
+  for (auto [inDim, sizeLog2] : inDims) {
+    auto &inDimBases = bases[S(inDim)];
+    for (int i = 0; i < sizeLog2; i++) {
+      auto &basis = inDimBases.emplace_back();
+      for (auto [outDim, outSizeLog2] : outDims)
+        basis.push_back(rng() & ((1 << outSizeLog2) - 1));
+    }
+  }
+  SmallVector<std::pair<StringAttr, int32_t>> outDimSizes;
+  for (auto [outDim, sizeLog2] : outDims)
+    outDimSizes.push_back({S(outDim), 1 << sizeLog2});
+  return LinearLayout(std::move(bases), outDimSizes,
+                      /*requireSurjective=*/false);
+}
+
+// A 128x128 tensor spread over 4 warps.
+LinearLayout randomDistributedLayout(std::mt19937 &rng) {
+  return randomLayout(
+      rng, {{"register", 7}, {"lane", 5}, {"warp", 2}, {"block", 0}},
+      {{"dim0", 7}, {"dim1", 7}});
+}
+
+LinearLayout randomSharedLayout(std::mt19937 &rng) {
+  return randomLayout(rng, {{"dim0", 7}, {"dim1", 7}}, {{"offset", 14}});
+}
+
+void BM_Apply(benchmark::State &state) {
+  std::mt19937 rng(0);
+  LinearLayout layout = randomDistributedLayout(rng);
+  int32_t i = 0;
+  for (auto _ : state) {
+    auto outs = layout.apply({{S("register"), i & 127},
+                              {S("lane"), (i >> 7) & 31},
+                              {S("warp"), (i >> 12) & 3},
+                              {S("block"), 0}});
+    benchmark::DoNotOptimize(outs);
+    i++;
+  }
+}
+BENCHMARK(BM_Apply);
+
+// Construction checks the layout's invariants, including its surjectivity.
+void BM_Construct(benchmark::State &state) {
+  std::mt19937 rng(0);
+  LinearLayout layout = randomDistributedLayout(rng);
+  SmallVector<std::pair<StringAttr, int32_t>> outDims;
+  for (StringAttr outDim : layout.getOutDimNames())
+    outDims.push_back({outDim, layout.getOutDimSize(outDim)});
+  for (auto _ : state) {
+    LinearLayout copy(layout.getBases(), outDims,
+                      /*requireSurjective=*/false);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_Construct);
+
+void BM_GetFreeVariableMasks(benchmark::State &state) {
+  std::mt19937 rng(0);
+  LinearLayout layout = randomDistributedLayout(rng);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(layout.getFreeVariableMasks());
+}
+BENCHMARK(BM_GetFreeVariableMasks);
+
+// Args: {number of distinct pairs of layouts}.  compose is memoized, so a
+// single pair measures cache hits, and more pairs than the cache holds measure
+// the composition itself.
+void BM_Compose(benchmark::State &state) {
+  std::mt19937 rng(0);
+  std::vector<std::pair<LinearLayout, LinearLayout>> pairs;
+  for (int i = 0; i < state.range(0); i++)
+    pairs.emplace_back(randomDistributedLayout(rng), randomSharedLayout(rng));
+  size_t i = 0;
+  for (auto _ : state) {
+    auto &[inner, outer] = pairs[i++ % pairs.size()];
+    benchmark::DoNotOptimize(inner.compose(outer));
+  }
+}
+BENCHMARK(BM_Compose)->Arg(1)->Arg(1 << 15);
+
+} // namespace
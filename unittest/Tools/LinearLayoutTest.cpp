@@ -5,6 +5,7 @@
 #include "llvm/Support/Signals.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <thread>
 
 namespace mlir {
 std::ostream &operator<<(std::ostream &os, StringAttr str) {
@@ -205,6 +206,23 @@ TEST_F(LinearLayoutTest, Apply) {
               ElementsAre(Pair(S("out1"), 1), Pair(S("out2"), 2)));
 }
 
+TEST_F(LinearLayoutTest, BasisMasks) {
+  LinearLayout layout(
+      {
+          {S("in1"), {{4, 2}, {2, 1}, {1, 0}}},
+          {S("in2"), {{1, 2}, {2, 1}}},
+      },
+      {{S("out1"), 8}, {S("out2"), 4}}, /*requireSurjective=*/false);
+  // out1 is packed in bits [0, 3) and out2 in bits [3, 5).
+  EXPECT_THAT(layout.getBasisMasks(),
+              ElementsAre(0b10100, 0b01010, 0b00001, 0b10001, 0b01010));
+  // The masks have rank 4, so only 16 of the 32 outputs are reached.
+  EXPECT_FALSE(layout.isSurjective());
+  // in2=2 maps to the same value as in1=2.
+  EXPECT_THAT(layout.getFreeVariableMasks(),
+              ElementsAre(Pair(S("in1"), 0), Pair(S("in2"), 2)));
+}
+
 // This is really more of a benchmark than a test.  We're checking that it
 // doesn't take so long to run that a human notices and says "hmm".  :)
 TEST_F(LinearLayoutTest, ConstructLargeLayout) {
@@ -388,6 +406,46 @@ TEST_F(LinearLayoutTest, InvertAndCompose_Simple) {
   EXPECT_EQ(composition.compose(l2), l1);
 }
 
+TEST_F(LinearLayoutTest, InvertAndCompose_CachedPerContext) {
+  // Results are cached by the interned dims, so a layout from another context
+  // with the same names gets a result with dims from its own context.
+  MLIRContext otherCtx;
+  auto T = [&](StringRef str) { return StringAttr::get(&otherCtx, str); };
+  LinearLayout l1({{S("in1"), {{2}, {1}, {4}}}}, {S("out")});
+  LinearLayout l2({{S("in2"), {{4}, {1}, {2}}}}, {S("out")});
+  LinearLayout otherL1({{T("in1"), {{2}, {1}, {4}}}}, {T("out")});
+  LinearLayout otherL2({{T("in2"), {{4}, {1}, {2}}}}, {T("out")});
+  EXPECT_EQ(l1.invertAndCompose(l2),
+            LinearLayout({{S("in1"), {{4}, {2}, {1}}}}, {S("in2")}));
+  LinearLayout otherComposition = otherL1.invertAndCompose(otherL2);
+  EXPECT_EQ(otherComposition,
+            LinearLayout({{T("in1"), {{4}, {2}, {1}}}}, {T("in2")}));
+  EXPECT_TRUE(otherComposition.isSurjective());
+  EXPECT_EQ(otherComposition.compose(otherL2), otherL1);
+  // A missing result is cached as well.
+  EXPECT_FALSE(l1.quotient({S("in1")}).has_value());
+  EXPECT_FALSE(otherL1.quotient({T("in1")}).has_value());
+}
+
+TEST_F(LinearLayoutTest, InvertAndCompose_CachedPerThread) {
+  // Each thread has its own cache, and they all get the same results.
+  LinearLayout l1({{S("in1"), {{2}, {1}, {4}}}}, {S("out")});
+  LinearLayout l2({{S("in2"), {{4}, {1}, {2}}}}, {S("out")});
+  LinearLayout expected({{S("in1"), {{4}, {2}, {1}}}}, {S("in2")});
+  std::vector<LinearLayout> results(8, LinearLayout::empty());
+  std::vector<std::thread> threads;
+  for (auto &result : results) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 100; i++)
+        result = l1.invertAndCompose(l2);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  for (auto &result : results)
+    EXPECT_EQ(result, expected);
+}
+
 TEST_F(LinearLayoutTest, InvertAndCompose_NonInjective) {
   LinearLayout l1({{S("in1"), {{2}, {1}, {4}}}}, {S("out")});
   LinearLayout l2({{S("in2"), {{0}, {2}, {1}, {4}}}}, {S("out")});